@@ -0,0 +1,300 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file batch.c
+ * @brief Batch processing on a pool of worker threads
+ */
+
+#include "jabpro.h"
+#include "encoder.h"
+#include "batch.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ * @brief Range of items owned by a worker, other workers steal from it when their own range is done
+*/
+typedef struct {
+    _Alignas( JPRO_CACHE_LINE_SIZE ) atomic_size_t next;      //the next unclaimed item
+    size_t end;
+}jpro_work_range;
+
+/**
+ * @brief Work pool shared by all workers of a batch
+*/
+typedef struct {
+    jpro_work_range*    ranges;
+    jpro_int32          range_cnt;
+    jpro_batch_work     work;
+    void*               context;
+}jpro_work_pool;
+
+/**
+ * @brief Worker of a work pool
+*/
+typedef struct {
+    jpro_work_pool*     pool;
+    jpro_int32          id;         //the index of the own range
+}jpro_worker;
+
+/**
+ * @brief Batch of profiles to be encoded
+*/
+typedef struct {
+    jpro_profile_info** profiles;
+    jpro_data**         encoded_profiles;
+    jpro_error_code*    errors;
+}jpro_encode_batch;
+
+/**
+ * @brief Batch of seals to be decoded
+*/
+typedef struct {
+    jpro_data**         seals;
+    jpro_profile_info** decoded_profiles;
+    jpro_error_code*    errors;
+    jpro_byte*          types;          //the profile type of every seal | JPRO_BATCH_INVALID_TYPE
+    size_t*             order;          //the seals grouped by profile type
+    size_t              seal_cnt;
+}jpro_decode_batch;
+
+/**
+ * @brief Claim the next item of a range
+ * @param range the range
+ * @param[out] index the index of the claimed item
+ * @return 1: success | 0: the range is done
+*/
+static jpro_boolean claim_item( jpro_work_range* range, size_t* index )
+{
+    if( atomic_load_explicit( &range->next, memory_order_relaxed ) >= range->end )
+    {
+        return 0;
+    }
+    *index = atomic_fetch_add_explicit( &range->next, 1, memory_order_relaxed );
+    return *index < range->end;
+}
+
+/**
+ * @brief Work on the own range, then steal items from the ranges of the other workers
+ * @param arg the worker
+ * @return NULL
+*/
+static void* run_worker( void* arg )
+{
+    jpro_worker* worker = arg;
+    jpro_work_pool* pool = worker->pool;
+    size_t index;
+    for( jpro_int32 i = 0; i < pool->range_cnt; i++ )
+    {
+        jpro_work_range* range = &pool->ranges[( worker->id + i ) % pool->range_cnt];
+        while( claim_item( range, &index ) )
+        {
+            pool->work( pool->context, worker->id, index );
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Run the work on every item of a batch on a pool of threads, the calling thread is one of them.
+ * Every thread starts with an equal share of the items and steals from the others when it is done, so that
+ * items of different cost balance out. If threads cannot be created the remaining ones do all the work.
+ * @param item_cnt the number of items
+ * @param thread_cnt the number of threads | 0: JPRO_BATCH_DEFAULT_THREAD_CNT
+ * @param work the work on a single item, it must be thread-safe
+ * @param context the context passed to the work
+*/
+void run_batch( size_t item_cnt, jpro_int32 thread_cnt, jpro_batch_work work, void* context )
+{
+    if( thread_cnt <= 0 )
+    {
+        thread_cnt = JPRO_BATCH_DEFAULT_THREAD_CNT;
+    }
+    if( thread_cnt > JPRO_BATCH_MAX_THREAD_CNT )
+    {
+        thread_cnt = JPRO_BATCH_MAX_THREAD_CNT;
+    }
+    if( (size_t) thread_cnt > item_cnt )
+    {
+        thread_cnt = item_cnt;
+    }
+    if( thread_cnt <= 1 )
+    {
+        for( size_t i = 0; i < item_cnt; i++ )
+        {
+            work( context, 0, i );
+        }
+        return;
+    }
+
+    jpro_work_range ranges[JPRO_BATCH_MAX_THREAD_CNT];
+    jpro_worker workers[JPRO_BATCH_MAX_THREAD_CNT];
+    pthread_t threads[JPRO_BATCH_MAX_THREAD_CNT];
+    jpro_work_pool pool = { ranges, thread_cnt, work, context };
+    for( jpro_int32 i = 0; i < thread_cnt; i++ )
+    {
+        atomic_init( &ranges[i].next, item_cnt * i / thread_cnt );
+        ranges[i].end = item_cnt * ( i + 1 ) / thread_cnt;
+        workers[i].pool = &pool;
+        workers[i].id = i;
+    }
+
+    jpro_int32 started_cnt = 1;
+    for( ; started_cnt < thread_cnt; started_cnt++ )
+    {
+        if( pthread_create( &threads[started_cnt], 0, run_worker, &workers[started_cnt] ) != 0 )
+        {
+            break;
+        }
+    }
+    run_worker( &workers[0] );
+    for( jpro_int32 i = 1; i < started_cnt; i++ )
+    {
+        pthread_join( threads[i], 0 );
+    }
+}
+
+/**
+ * @brief Encode a single profile of a batch
+ * @param context the batch
+ * @param worker the index of the worker thread
+ * @param index the index of the profile
+*/
+static void encode_batch_item( void* context, jpro_int32 worker, size_t index )
+{
+    (void) worker;
+    jpro_encode_batch* batch = context;
+    batch->encoded_profiles[index] = encode_profile( batch->profiles[index] );
+    if( batch->encoded_profiles[index] == 0 && batch->errors != 0 )
+    {
+        batch->errors[index] = get_last_error_code();
+    }
+}
+
+/**
+ * @brief Encode profiles on a pool of threads
+ * @param[in]  profiles the profiles to be encoded
+ * @param[in]  profile_cnt the number of profiles
+ * @param[out] encoded_profiles the encoded profiles, NULL for every profile that failed
+ * @param[in]  opts the batch options | NULL: default options
+ * @return the number of encoded profiles
+*/
+size_t encode_profiles_batch(jpro_profile_info** profiles, size_t profile_cnt, jpro_data** encoded_profiles, jpro_batch_opts* opts)
+{
+    jpro_encode_batch batch = { profiles, encoded_profiles, opts ? opts->errors : 0 };
+    run_batch( profile_cnt, opts ? opts->thread_cnt : 0, encode_batch_item, &batch );
+
+    size_t encoded_cnt = 0;
+    for( size_t i = 0; i < profile_cnt; i++ )
+    {
+        encoded_cnt += encoded_profiles[i] != 0;
+    }
+    return encoded_cnt;
+}
+
+/**
+ * @brief Peek the header of a single seal of a batch to get its profile type
+ * @param context the batch
+ * @param worker the index of the worker thread
+ * @param index the index of the seal
+*/
+static void peek_batch_item( void* context, jpro_int32 worker, size_t index )
+{
+    (void) worker;
+    jpro_decode_batch* batch = context;
+    jpro_header_view header;
+    if( jpro_peek_header( batch->seals[index]->data, batch->seals[index]->length, &header ) == 0 )
+    {
+        batch->types[index] = JPRO_BATCH_INVALID_TYPE;
+        batch->decoded_profiles[index] = 0;
+        if( batch->errors != 0 )
+        {
+            batch->errors[index] = get_last_error_code();
+        }
+        return;
+    }
+    batch->types[index] = header.type;
+}
+
+/**
+ * @brief Decode a single seal of a batch in the order grouped by profile type
+ * @param context the batch
+ * @param worker the index of the worker thread
+ * @param position the position in the grouped order
+*/
+static void decode_batch_item( void* context, jpro_int32 worker, size_t position )
+{
+    (void) worker;
+    jpro_decode_batch* batch = context;
+    if( position + 1 < batch->seal_cnt )
+    {
+        __builtin_prefetch( batch->seals[batch->order[position + 1]]->data );
+    }
+    const size_t index = batch->order[position];
+    batch->decoded_profiles[index] = decode_profile_block( batch->seals[index] );
+    if( batch->decoded_profiles[index] == 0 && batch->errors != 0 )
+    {
+        batch->errors[index] = get_last_error_code();
+    }
+}
+
+/**
+ * @brief Decode seals on a pool of threads. The headers are peeked first and the seals are decoded grouped by
+ * profile type, so that the tables of a profile stay in the cache.
+ * @param[in]  seals the seals or encoded profiles to be decoded
+ * @param[in]  seal_cnt the number of seals
+ * @param[out] decoded_profiles the decoded profiles, to be released with free_profile_block, NULL for every seal that failed
+ * @param[in]  opts the batch options | NULL: default options
+ * @return the number of decoded profiles
+*/
+size_t decode_profiles_batch(jpro_data** seals, size_t seal_cnt, jpro_profile_info** decoded_profiles, jpro_batch_opts* opts)
+{
+    jpro_decode_batch batch = { seals, decoded_profiles, opts ? opts->errors : 0, malloc( seal_cnt + 1 ), malloc( sizeof( size_t ) * ( seal_cnt + 1 ) ), 0 };
+    if( batch.types == 0 || batch.order == 0 )
+    {
+        free( batch.types );
+        free( batch.order );
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    const jpro_int32 thread_cnt = opts ? opts->thread_cnt : 0;
+    run_batch( seal_cnt, thread_cnt, peek_batch_item, &batch );
+
+    //group the seals by profile type with a counting sort, seals with invalid headers are left out
+    size_t type_start[JPRO_PROFILE_CNT + 1] = { 0 };
+    for( size_t i = 0; i < seal_cnt; i++ )
+    {
+        if( batch.types[i] != JPRO_BATCH_INVALID_TYPE )
+        {
+            type_start[batch.types[i] + 1]++;
+        }
+    }
+    for( jpro_int32 type = 0; type < JPRO_PROFILE_CNT; type++ )
+    {
+        type_start[type + 1] += type_start[type];
+    }
+    batch.seal_cnt = type_start[JPRO_PROFILE_CNT];
+    for( size_t i = 0; i < seal_cnt; i++ )
+    {
+        if( batch.types[i] != JPRO_BATCH_INVALID_TYPE )
+        {
+            batch.order[type_start[batch.types[i]]++] = i;
+        }
+    }
+    run_batch( batch.seal_cnt, thread_cnt, decode_batch_item, &batch );
+    free( batch.types );
+    free( batch.order );
+
+    size_t decoded_cnt = 0;
+    for( size_t i = 0; i < seal_cnt; i++ )
+    {
+        decoded_cnt += decoded_profiles[i] != 0;
+    }
+    return decoded_cnt;
+}
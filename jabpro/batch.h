@@ -0,0 +1,31 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file batch.h
+ * @brief Batch processing header
+ */
+
+#ifndef JABPRO_BATCH_H
+#define JABPRO_BATCH_H
+
+#define JPRO_BATCH_DEFAULT_THREAD_CNT   4       //the number of threads if the options do not set one
+#define JPRO_BATCH_MAX_THREAD_CNT       64
+#define JPRO_CACHE_LINE_SIZE            64
+#define JPRO_BATCH_INVALID_TYPE         0xFF    //the profile type of a seal whose header cannot be read
+
+/**
+ * @brief Work on a single item of a batch
+ * @param context the batch the item belongs to
+ * @param worker the index of the worker thread, less than JPRO_BATCH_MAX_THREAD_CNT, for per-thread state
+ * @param index the index of the item
+*/
+typedef void (*jpro_batch_work)( void* context, jpro_int32 worker, size_t index );
+
+extern void run_batch( size_t item_cnt, jpro_int32 thread_cnt, jpro_batch_work work, void* context );
+
+#endif
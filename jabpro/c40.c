@@ -16,9 +16,190 @@
  #include <stddef.h>
  #include <string.h>
  #include <stdlib.h>
- #include <math.h>
- #include <ctype.h>
- #include <stdio.h>
+
+ /**
+ * @brief C40 value of every input character ( 0: not in the C40 basic set, '<' is encoded as space )
+ */
+ static const jpro_byte c40_value_table[256] = {
+    [' '] = 3,  ['<'] = 3,
+    ['0'] = 4,  ['1'] = 5,  ['2'] = 6,  ['3'] = 7,  ['4'] = 8,
+    ['5'] = 9,  ['6'] = 10, ['7'] = 11, ['8'] = 12, ['9'] = 13,
+    ['A'] = 14, ['B'] = 15, ['C'] = 16, ['D'] = 17, ['E'] = 18, ['F'] = 19, ['G'] = 20,
+    ['H'] = 21, ['I'] = 22, ['J'] = 23, ['K'] = 24, ['L'] = 25, ['M'] = 26, ['N'] = 27,
+    ['O'] = 28, ['P'] = 29, ['Q'] = 30, ['R'] = 31, ['S'] = 32, ['T'] = 33, ['U'] = 34,
+    ['V'] = 35, ['W'] = 36, ['X'] = 37, ['Y'] = 38, ['Z'] = 39
+ };
+
+ /**
+ * @brief Character of every C40 value ( 0: shift values, not supported )
+ */
+ static const jpro_char c40_char_table[40] = {   0,   0,   0, '<', '0', '1', '2', '3', '4', '5',
+                                                '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
+                                                'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+                                                'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z'
+                                              };
+
+ /**
+ * @brief Decoded triple of every 16-bit C40 word: three characters (unused ones are 0) followed by the number of characters ( 0: invalid word )
+ */
+ static jpro_byte c40_word_table[65536][4];
+
+ /**
+ * @brief Fill the word table, run once at program start
+ */
+ __attribute__((constructor)) static void c40_build_word_table( void )
+ {
+     for( jpro_int32 word = 0; word < 65536; word++ )
+     {
+         jpro_byte* entry = c40_word_table[word];
+         if( ( word >> 8 ) == 0xfe )                                          //padding (val, , ): ASCII value + 1
+         {
+             entry[0] = ( word & 0xff ) - 1;
+             entry[3] = 1;
+             continue;
+         }
+         jpro_uint16 V16 = word - 1;
+         jpro_uint16 U1 = V16 / 1600;
+         jpro_uint16 U2 = ( V16 % 1600 ) / 40;
+         jpro_uint16 U3 = V16 % 40;
+         if( U1 >= 40 || c40_char_table[U1] == 0 || c40_char_table[U2] == 0 )
+         {
+             continue;
+         }
+         entry[0] = c40_char_table[U1];
+         entry[1] = c40_char_table[U2];
+         if( U3 == 0 )                                                        //padding (val,val, )
+         {
+             entry[3] = 2;
+         }
+         else if( c40_char_table[U3] != 0 )
+         {
+             entry[2] = c40_char_table[U3];
+             entry[3] = 3;
+         }
+     }
+ }
+
+ /**
+ * @brief Raise the error for the first character of a string that has no C40 value
+ * @param s the string
+ * @param length the number of characters to check
+ * @return 0
+ */
+ static jpro_boolean c40_report_invalid_char( const jpro_char* s, jpro_int32 length )
+ {
+     for( jpro_int32 position = 0; position < length; position++ )
+     {
+         if( c40_value_table[(jpro_byte)s[position]] == 0 )
+         {
+             get_c40_value( s[position] );
+             break;
+         }
+     }
+     return 0;
+ }
+
+ /**
+ * @brief Encode a string using the C40 scheme into a buffer
+ * @param s the string to be encoded
+ * @param length the length of the string
+ * @param[out] out the output buffer, at least C40_ENCODED_LENGTH(length) bytes
+ * @return 1: success | 0: error occurs
+*/
+ jpro_boolean c40_encode_into( const jpro_char* s, jpro_int32 length, jpro_byte* out )
+ {
+     const jpro_byte* in = (const jpro_byte*) s;
+     jpro_int32 triples = c40_kernels.encode( in, length / 3, out );         //vectorized bulk, the rest is table-driven
+     jpro_int32 position = triples * 3;
+     out += triples * 2;
+     for( ; position + 3 <= length; position += 3 )
+     {
+         jpro_uint32 C1 = c40_value_table[in[position]];
+         jpro_uint32 C2 = c40_value_table[in[position + 1]];
+         jpro_uint32 C3 = c40_value_table[in[position + 2]];
+         if( C1 == 0 || C2 == 0 || C3 == 0 )
+         {
+             return c40_report_invalid_char( s + position, 3 );
+         }
+         jpro_uint32 I16 = ( 1600 * C1 ) + ( 40 * C2 ) + C3 + 1;
+         *out++ = I16 >> 8;
+         *out++ = I16 & 0xff;
+     }
+
+     if( length - position == 2 )                                             //padding
+     {
+         jpro_uint32 C1 = c40_value_table[in[position]];
+         jpro_uint32 C2 = c40_value_table[in[position + 1]];
+         if( C1 == 0 || C2 == 0 )
+         {
+             return c40_report_invalid_char( s + position, 2 );
+         }
+         jpro_uint32 I16 = ( 1600 * C1 ) + ( 40 * C2 ) + 0 + 1;
+         out[0] = I16 >> 8;
+         out[1] = I16 & 0xff;
+     }
+     else if( length - position == 1 )
+     {
+         if( c40_value_table[in[position]] == 0 )
+         {
+             return c40_report_invalid_char( s + position, 1 );
+         }
+         out[0] = 254;
+         out[1] = in[position] + 1;                                           //ASCII value + 1
+     }
+     return 1;
+ }
+
+ /**
+ * @brief Decode C40 encoded data into a buffer
+ * @param in the encoded data
+ * @param length the length of the encoded data
+ * @param[out] out the output buffer, at least C40_DECODED_LENGTH(length) + 1 characters, terminated with '\0'
+ * @return 1: success | 0: error occurs
+*/
+ jpro_boolean c40_decode_into( const jpro_byte* in, jpro_int32 length, jpro_char* out )
+ {
+     jpro_int32 words = c40_kernels.decode( in, length / 2, out );          //vectorized bulk, the rest is table-driven
+     jpro_int32 position = words * 2;
+     out += words * 3;
+     for( ; position + 1 < length; position += 2 )
+     {
+         const jpro_byte* entry = c40_word_table[( in[position] << 8 ) | in[position + 1]];
+         if( entry[3] == 0 )
+         {
+             error_handler( "Failed to get Char for c40 Value" , C40_VALUE_UNKNOWN );
+             return 0;
+         }
+         memcpy( out, entry, 3 );
+         out += 3;
+     }
+     *out = '\0';
+     return 1;
+ }
+
+ /**
+ * @brief Decode many C40 encoded fields back to back, e.g. the MRZ fields of a batch of seals
+ * @param in the encoded fields
+ * @param lengths the length of every encoded field
+ * @param count the number of fields
+ * @param[out] out the output buffers, out[i] at least C40_DECODED_LENGTH(lengths[i]) + 1 characters
+ * @return the number of decoded fields, less than count if decoding field out[return value] failed
+*/
+ jpro_int32 c40_decode_many( const jpro_byte** in, const jpro_int32* lengths, jpro_int32 count, jpro_char** out )
+ {
+     for( jpro_int32 i = 0; i < count; i++ )
+     {
+         if( i + 1 < count )
+         {
+             __builtin_prefetch( in[i + 1] );
+         }
+         if( c40_decode_into( in[i], lengths[i], out[i] ) == 0 )
+         {
+             return i;
+         }
+     }
+     return count;
+ }
 
  /**
  * @brief Encode a string using the C40 scheme
@@ -28,66 +209,21 @@
  jpro_data* c40_encode(jpro_char* s)
  {
     const jpro_int32 length = strlen( s );
-    jpro_int32* c40_values = malloc( sizeof(jpro_int32) * length);
-    if ( c40_values == NULL )
-    {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return 0;
-    }
-    jpro_double size = length;
 
-    jpro_data* c40_enocoded_data = malloc( sizeof( jpro_data ) + sizeof ( jpro_byte ) * ceil( size / 3 ) * 2 );
+    jpro_data* c40_enocoded_data = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * C40_ENCODED_LENGTH( length ) );
     if ( c40_enocoded_data == NULL )
     {
         error_handler( "Out of memory", OUT_OF_MEMORY );
         return 0;
     }
-    c40_enocoded_data->length = ceil( size / 3 ) * 2;        //for each 3 c40 values there are 2 values to be added to data_encoded
+    c40_enocoded_data->length = C40_ENCODED_LENGTH( length );        //for each 3 c40 values there are 2 values to be added to data_encoded
 
-
-    for ( jpro_int32 position = 0; position < length; position++ )    //getting c40 value(s) for every character of the string
+    if( c40_encode_into( s, length, c40_enocoded_data->data ) == 0 )
     {
-       if ( s[position] == '<' )
-       {
-            c40_values[position] = get_c40_value( ' ' );
-       }
-       else if ( get_c40_value( s[position] ) != 0 )
-       {
-            c40_values[position] = get_c40_value( s[position] );
-       }
-       else
-       {
-		   //error handled in get_c40_value
-           return NULL;
-       }
-     }
-
-     for ( jpro_int32 position = 0; position < length; position+=3 )
-     {
-        if( length - position < 3 )                             //Padding
-        {
-            if( length - position == 2 )
-            {
-                jpro_uint16 I16 = ( 1600 * c40_values[position]  ) + ( 40 * c40_values[position+1] ) + 0 + 1;
-                c40_enocoded_data->data[( position / 3 ) * 2] = I16 / 256;
-                c40_enocoded_data->data[( position / 3 ) * 2 + 1] = I16 % 256;
-            }
-            else if( length - position == 1 )
-            {
-                c40_enocoded_data->data[( position / 3 ) * 2] = 254;
-                c40_enocoded_data->data[( position / 3 ) * 2 + 1] = s[position] + 1;         //ASCII value + 1
-            }
-        }
-        else
-        {
-            jpro_uint16 I16 = ( 1600 * c40_values[position]  ) + ( 40 * c40_values[position+1] ) + c40_values[position+2] + 1;
-            c40_enocoded_data->data[( position / 3 ) * 2] = I16 / 256;
-            c40_enocoded_data->data[( position / 3 ) * 2 + 1] = I16 % 256;
-        }
-     }
-     free( c40_values );
-
-	 return c40_enocoded_data;
+        free( c40_enocoded_data );
+        return NULL;
+    }
+	return c40_enocoded_data;
  }
 
 /**
@@ -97,50 +233,18 @@
 */
  jpro_char* c40_decode(jpro_data* encoded_data)
  {
-     jpro_int32 return_val_len = encoded_data->length * 3/2;
-     jpro_char* return_val = malloc( sizeof( jpro_char ) * (return_val_len + 1 ));
+     jpro_char* return_val = malloc( sizeof( jpro_char ) * ( C40_DECODED_LENGTH( encoded_data->length ) + 1 ));
      if( return_val == NULL )
      {
          error_handler( "Out of memory", OUT_OF_MEMORY );
          return 0;
      }
 
-     for ( jpro_int32 position = 0; position < encoded_data->length; position+=2 )
+     if( c40_decode_into( encoded_data->data, encoded_data->length, return_val ) == 0 )
      {
-        if( encoded_data->data[position] == 0xfe )                             //padding (val, , )
-        {
-            jpro_uint16 U1 = encoded_data->data[position + 1] - 1;
-            snprintf( return_val + (position*3/2), 2, "%c", U1 );
-        }
-        else
-        {
-            jpro_uint16 I1 = encoded_data->data[position];
-            jpro_uint16 I2 = encoded_data->data[position+1];
-            jpro_uint16 V16 = ( I1 * 256 ) + I2;
-
-            jpro_uint16 U1 = ( V16 - 1 ) / 1600;
-            jpro_uint16 U2 = ( V16 - ( U1 * 1600 ) - 1 ) / 40;
-            jpro_uint16 U3 = V16 - ( U1 * 1600 ) - ( U2 * 40 ) - 1;
-
-            if( U3 == 0 )                                                       //padding (val,val, )
-            {
-                if( get_char_c40( U1 ) == 0 || get_char_c40( U2 )== 0 )
-                {
-                    return 0; //error handled in get_char_c40
-                }
-                snprintf( return_val + (position * 3/2), 3, "%c%c", get_char_c40( U1 ), get_char_c40( U2 ) );
-            }
-            else
-            {
-                if( get_char_c40( U1 ) == 0 || get_char_c40( U2 )== 0 || get_char_c40( U3 ) == 0 )
-                {
-                    return 0; //error handled in get_char_c40
-                }
-                snprintf( return_val + (position * 3/2), 4, "%c%c%c", get_char_c40( U1 ), get_char_c40( U2 ), get_char_c40( U3 ) );
-            }
-        }
+         free( return_val );
+         return 0;
      }
-
 	 return return_val;
  }
 
@@ -151,25 +255,13 @@
   */
  jpro_int32 get_c40_value( jpro_char c )
  {
-     if ( c == ' ' )
+     jpro_int32 value = c40_value_table[(jpro_byte)c];
+     if( value == 0 )
      {
-         return 3;
-     }
-     else if( isalpha( c ) &&
-              ( c - 51 ) < 40 )
-     {
-        return ( c - 51 );
-     }
-     else if( isdigit( c ) )
-     {
-        return ( c - 44 );
-     }
-     else
-     {
-         jpro_char error_msg[256];
-         error_handler( cat_strings( error_msg, "Failed to get c40 value for: ", &c, "") , C40_VALUE_UNKNOWN );
-         return 0;
+         jpro_char c_str[2] = { c, '\0' };
+         error_handler_detail( "Failed to get c40 value for: ", c_str, C40_VALUE_UNKNOWN );
      }
+     return value;
  }
 
 /**
@@ -179,21 +271,10 @@
 */
  jpro_char get_char_c40( jpro_uint16 i )
  {
-     if( i < 14 && i > 3 )
+     if( i < 40 && c40_char_table[i] != 0 )
      {
-         return ( i + 44 );
-     }
-     else if( i == 3 )
-     {
-         return '<';
-     }
-     else if( i > 13 && i < 40 )
-     {
-         return ( i + 51 );
-     }
-     else
-     {
-         error_handler( "Failed to get Char for c40 Value" , C40_VALUE_UNKNOWN );
-         return 0;
+         return c40_char_table[i];
      }
+     error_handler( "Failed to get Char for c40 Value" , C40_VALUE_UNKNOWN );
+     return 0;
  }
@@ -24,6 +24,29 @@ static const jpro_char c40_char_set[40] = {	'-', '-', '-', ' ', '0', '1', '2', '
 										  };
 */
 
+/**
+ * @brief Number of bytes of a C40 encoded string of n characters
+*/
+#define C40_ENCODED_LENGTH(n) ( ( ( (n) + 2 ) / 3 ) * 2 )
+/**
+ * @brief Number of characters of n C40 encoded bytes
+*/
+#define C40_DECODED_LENGTH(n) ( ( (n) / 2 ) * 3 )
+
+/**
+ * @brief C40 batch kernels, selected at program start by CPU feature detection
+*/
+typedef struct {
+	const jpro_char*	name;																//"scalar", "sse4.1" or "avx2"
+	jpro_int32 (*encode)( const jpro_byte* in, jpro_int32 triples, jpro_byte* out );		//returns the number of complete triples encoded
+	jpro_int32 (*decode)( const jpro_byte* in, jpro_int32 words, jpro_char* out );		//returns the number of 16-bit words decoded
+}jpro_c40_kernels;
+
+extern jpro_c40_kernels c40_kernels;
+
+extern jpro_boolean c40_encode_into( const jpro_char* s, jpro_int32 length, jpro_byte* out );
+extern jpro_boolean c40_decode_into( const jpro_byte* in, jpro_int32 length, jpro_char* out );
+extern jpro_int32 c40_decode_many( const jpro_byte** in, const jpro_int32* lengths, jpro_int32 count, jpro_char** out );
 extern jpro_data* c40_encode(jpro_char* s);
 extern jpro_char* c40_decode(jpro_data* encoded_data);
 extern jpro_int32 get_c40_value( jpro_char c );
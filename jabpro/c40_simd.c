@@ -0,0 +1,287 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file c40_simd.c
+ * @brief Vectorized C40 batch kernels with runtime dispatch
+ */
+
+#include "jabpro.h"
+#include "c40.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define JPRO_C40_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Scalar kernels, leave all triples to the table-driven loop in c40.c
+*/
+static jpro_int32 c40_encode_scalar( const jpro_byte* in, jpro_int32 triples, jpro_byte* out )
+{
+    (void) in;
+    (void) triples;
+    (void) out;
+    return 0;
+}
+
+static jpro_int32 c40_decode_scalar( const jpro_byte* in, jpro_int32 words, jpro_char* out )
+{
+    (void) in;
+    (void) words;
+    (void) out;
+    return 0;
+}
+
+/**
+ * @brief The kernels in use, selected at program start
+*/
+jpro_c40_kernels c40_kernels = { "scalar", c40_encode_scalar, c40_decode_scalar };
+
+#ifdef JPRO_C40_X86
+
+/**
+ * @brief Swap the two bytes of every 16-bit lane (C40 words are big-endian)
+*/
+static const jpro_byte c40_swap_mask[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+
+/**
+ * @brief Gather the 1st, 2nd and 3rd character of 8 triples (24 bytes split into 16 + 8) into 16-bit lanes
+*/
+static const jpro_byte c40_gather_mask[6][16] = {
+    { 0x00, 0x80, 0x03, 0x80, 0x06, 0x80, 0x09, 0x80, 0x0c, 0x80, 0x0f, 0x80, 0x80, 0x80, 0x80, 0x80 },
+    { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x02, 0x80, 0x05, 0x80 },
+    { 0x01, 0x80, 0x04, 0x80, 0x07, 0x80, 0x0a, 0x80, 0x0d, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+    { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x80, 0x03, 0x80, 0x06, 0x80 },
+    { 0x02, 0x80, 0x05, 0x80, 0x08, 0x80, 0x0b, 0x80, 0x0e, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+    { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0x80, 0x04, 0x80, 0x07, 0x80 }
+};
+
+/**
+ * @brief Interleave 8 decoded triples, packed as [1st x8, 2nd x8] and [3rd x8], into 24 output bytes (16 + 8)
+*/
+static const jpro_byte c40_scatter_mask[4][16] = {
+    { 0x00, 0x08, 0x80, 0x01, 0x09, 0x80, 0x02, 0x0a, 0x80, 0x03, 0x0b, 0x80, 0x04, 0x0c, 0x80, 0x05 },
+    { 0x80, 0x80, 0x00, 0x80, 0x80, 0x01, 0x80, 0x80, 0x02, 0x80, 0x80, 0x03, 0x80, 0x80, 0x04, 0x80 },
+    { 0x0d, 0x80, 0x06, 0x0e, 0x80, 0x07, 0x0f, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 },
+    { 0x80, 0x05, 0x80, 0x80, 0x06, 0x80, 0x80, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }
+};
+
+#define C40_MASK128(m) _mm_loadu_si128( (const __m128i*)(m) )
+#define C40_MASK256(m) _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)(m) ) )
+
+/**
+ * @brief Map characters in 16-bit lanes to C40 values, invalid lanes are set in bad
+*/
+__attribute__((target("sse4.1")))
+static inline __m128i c40_values_sse41( __m128i c, __m128i* bad )
+{
+    __m128i digit = _mm_and_si128( _mm_cmpgt_epi16( c, _mm_set1_epi16( '0' - 1 ) ), _mm_cmplt_epi16( c, _mm_set1_epi16( '9' + 1 ) ) );
+    __m128i upper = _mm_and_si128( _mm_cmpgt_epi16( c, _mm_set1_epi16( 'A' - 1 ) ), _mm_cmplt_epi16( c, _mm_set1_epi16( 'Z' + 1 ) ) );
+    __m128i space = _mm_or_si128( _mm_cmpeq_epi16( c, _mm_set1_epi16( ' ' ) ), _mm_cmpeq_epi16( c, _mm_set1_epi16( '<' ) ) );
+    *bad = _mm_or_si128( *bad, _mm_cmpeq_epi16( _mm_or_si128( _mm_or_si128( digit, upper ), space ), _mm_setzero_si128() ) );
+
+    __m128i value = _mm_and_si128( digit, _mm_sub_epi16( c, _mm_set1_epi16( 44 ) ) );
+    value = _mm_or_si128( value, _mm_and_si128( upper, _mm_sub_epi16( c, _mm_set1_epi16( 51 ) ) ) );
+    return _mm_or_si128( value, _mm_and_si128( space, _mm_set1_epi16( 3 ) ) );
+}
+
+/**
+ * @brief Map C40 values 3..39 in 16-bit lanes to characters
+*/
+__attribute__((target("sse4.1")))
+static inline __m128i c40_chars_sse41( __m128i u )
+{
+    __m128i c = _mm_add_epi16( u, _mm_set1_epi16( 44 ) );
+    c = _mm_add_epi16( c, _mm_and_si128( _mm_cmpgt_epi16( u, _mm_set1_epi16( 13 ) ), _mm_set1_epi16( 7 ) ) );
+    return _mm_blendv_epi8( c, _mm_set1_epi16( '<' ), _mm_cmpeq_epi16( u, _mm_set1_epi16( 3 ) ) );
+}
+
+/**
+ * @brief Encode 8 triples per iteration
+ * @return the number of triples encoded, stops before the first block with a character outside the C40 basic set
+*/
+__attribute__((target("sse4.1")))
+static jpro_int32 c40_encode_sse41( const jpro_byte* in, jpro_int32 triples, jpro_byte* out )
+{
+    jpro_int32 done = 0;
+    for( ; done + 8 <= triples; done += 8 )
+    {
+        const jpro_byte* p = in + done * 3;
+        __m128i x = _mm_loadu_si128( (const __m128i*) p );
+        __m128i y = _mm_loadl_epi64( (const __m128i*)( p + 16 ) );
+        __m128i c1 = _mm_or_si128( _mm_shuffle_epi8( x, C40_MASK128( c40_gather_mask[0] ) ), _mm_shuffle_epi8( y, C40_MASK128( c40_gather_mask[1] ) ) );
+        __m128i c2 = _mm_or_si128( _mm_shuffle_epi8( x, C40_MASK128( c40_gather_mask[2] ) ), _mm_shuffle_epi8( y, C40_MASK128( c40_gather_mask[3] ) ) );
+        __m128i c3 = _mm_or_si128( _mm_shuffle_epi8( x, C40_MASK128( c40_gather_mask[4] ) ), _mm_shuffle_epi8( y, C40_MASK128( c40_gather_mask[5] ) ) );
+
+        __m128i bad = _mm_setzero_si128();
+        __m128i v1 = c40_values_sse41( c1, &bad );
+        __m128i v2 = c40_values_sse41( c2, &bad );
+        __m128i v3 = c40_values_sse41( c3, &bad );
+        if( !_mm_testz_si128( bad, bad ) )
+        {
+            break;
+        }
+
+        __m128i I16 = _mm_add_epi16( _mm_mullo_epi16( v1, _mm_set1_epi16( 1600 ) ), _mm_mullo_epi16( v2, _mm_set1_epi16( 40 ) ) );
+        I16 = _mm_add_epi16( I16, _mm_add_epi16( v3, _mm_set1_epi16( 1 ) ) );
+        _mm_storeu_si128( (__m128i*)( out + done * 2 ), _mm_shuffle_epi8( I16, C40_MASK128( c40_swap_mask ) ) );
+    }
+    return done;
+}
+
+/**
+ * @brief Decode 8 words per iteration
+ * @return the number of words decoded, stops before the first block with a padding or invalid word
+*/
+__attribute__((target("sse4.1")))
+static jpro_int32 c40_decode_sse41( const jpro_byte* in, jpro_int32 words, jpro_char* out )
+{
+    jpro_int32 done = 0;
+    for( ; done + 8 <= words; done += 8 )
+    {
+        __m128i x = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*)( in + done * 2 ) ), C40_MASK128( c40_swap_mask ) );
+        x = _mm_sub_epi16( x, _mm_set1_epi16( 1 ) );
+        __m128i u1 = _mm_mulhi_epu16( _mm_srli_epi16( x, 6 ), _mm_set1_epi16( 2622 ) );               //x / 1600 = (x >> 6) / 25
+        __m128i r = _mm_sub_epi16( x, _mm_mullo_epi16( u1, _mm_set1_epi16( 1600 ) ) );
+        __m128i u2 = _mm_mulhi_epu16( _mm_srli_epi16( r, 3 ), _mm_set1_epi16( 13108 ) );              //r / 40 = (r >> 3) / 5
+        __m128i u3 = _mm_sub_epi16( r, _mm_mullo_epi16( u2, _mm_set1_epi16( 40 ) ) );
+
+        __m128i low = _mm_min_epu16( _mm_min_epu16( u1, u2 ), u3 );
+        __m128i bad = _mm_or_si128( _mm_cmpgt_epi16( u1, _mm_set1_epi16( 39 ) ), _mm_cmplt_epi16( low, _mm_set1_epi16( 3 ) ) );
+        if( !_mm_testz_si128( bad, bad ) )
+        {
+            break;
+        }
+
+        __m128i c12 = _mm_packus_epi16( c40_chars_sse41( u1 ), c40_chars_sse41( u2 ) );
+        __m128i c3 = _mm_packus_epi16( c40_chars_sse41( u3 ), _mm_setzero_si128() );
+        jpro_char* p = out + done * 3;
+        _mm_storeu_si128( (__m128i*) p, _mm_or_si128( _mm_shuffle_epi8( c12, C40_MASK128( c40_scatter_mask[0] ) ), _mm_shuffle_epi8( c3, C40_MASK128( c40_scatter_mask[1] ) ) ) );
+        _mm_storel_epi64( (__m128i*)( p + 16 ), _mm_or_si128( _mm_shuffle_epi8( c12, C40_MASK128( c40_scatter_mask[2] ) ), _mm_shuffle_epi8( c3, C40_MASK128( c40_scatter_mask[3] ) ) ) );
+    }
+    return done;
+}
+
+/**
+ * @brief Map characters in 16-bit lanes to C40 values, invalid lanes are set in bad
+*/
+__attribute__((target("avx2")))
+static inline __m256i c40_values_avx2( __m256i c, __m256i* bad )
+{
+    __m256i digit = _mm256_and_si256( _mm256_cmpgt_epi16( c, _mm256_set1_epi16( '0' - 1 ) ), _mm256_cmpgt_epi16( _mm256_set1_epi16( '9' + 1 ), c ) );
+    __m256i upper = _mm256_and_si256( _mm256_cmpgt_epi16( c, _mm256_set1_epi16( 'A' - 1 ) ), _mm256_cmpgt_epi16( _mm256_set1_epi16( 'Z' + 1 ), c ) );
+    __m256i space = _mm256_or_si256( _mm256_cmpeq_epi16( c, _mm256_set1_epi16( ' ' ) ), _mm256_cmpeq_epi16( c, _mm256_set1_epi16( '<' ) ) );
+    *bad = _mm256_or_si256( *bad, _mm256_cmpeq_epi16( _mm256_or_si256( _mm256_or_si256( digit, upper ), space ), _mm256_setzero_si256() ) );
+
+    __m256i value = _mm256_and_si256( digit, _mm256_sub_epi16( c, _mm256_set1_epi16( 44 ) ) );
+    value = _mm256_or_si256( value, _mm256_and_si256( upper, _mm256_sub_epi16( c, _mm256_set1_epi16( 51 ) ) ) );
+    return _mm256_or_si256( value, _mm256_and_si256( space, _mm256_set1_epi16( 3 ) ) );
+}
+
+/**
+ * @brief Map C40 values 3..39 in 16-bit lanes to characters
+*/
+__attribute__((target("avx2")))
+static inline __m256i c40_chars_avx2( __m256i u )
+{
+    __m256i c = _mm256_add_epi16( u, _mm256_set1_epi16( 44 ) );
+    c = _mm256_add_epi16( c, _mm256_and_si256( _mm256_cmpgt_epi16( u, _mm256_set1_epi16( 13 ) ), _mm256_set1_epi16( 7 ) ) );
+    return _mm256_blendv_epi8( c, _mm256_set1_epi16( '<' ), _mm256_cmpeq_epi16( u, _mm256_set1_epi16( 3 ) ) );
+}
+
+/**
+ * @brief Encode 16 triples per iteration, each 128-bit lane holds 8 triples
+ * @return the number of triples encoded, stops before the first block with a character outside the C40 basic set
+*/
+__attribute__((target("avx2")))
+static jpro_int32 c40_encode_avx2( const jpro_byte* in, jpro_int32 triples, jpro_byte* out )
+{
+    jpro_int32 done = 0;
+    for( ; done + 16 <= triples; done += 16 )
+    {
+        const jpro_byte* p = in + done * 3;
+        __m256i x = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*) p ) ), _mm_loadu_si128( (const __m128i*)( p + 24 ) ), 1 );
+        __m256i y = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadl_epi64( (const __m128i*)( p + 16 ) ) ), _mm_loadl_epi64( (const __m128i*)( p + 40 ) ), 1 );
+        __m256i c1 = _mm256_or_si256( _mm256_shuffle_epi8( x, C40_MASK256( c40_gather_mask[0] ) ), _mm256_shuffle_epi8( y, C40_MASK256( c40_gather_mask[1] ) ) );
+        __m256i c2 = _mm256_or_si256( _mm256_shuffle_epi8( x, C40_MASK256( c40_gather_mask[2] ) ), _mm256_shuffle_epi8( y, C40_MASK256( c40_gather_mask[3] ) ) );
+        __m256i c3 = _mm256_or_si256( _mm256_shuffle_epi8( x, C40_MASK256( c40_gather_mask[4] ) ), _mm256_shuffle_epi8( y, C40_MASK256( c40_gather_mask[5] ) ) );
+
+        __m256i bad = _mm256_setzero_si256();
+        __m256i v1 = c40_values_avx2( c1, &bad );
+        __m256i v2 = c40_values_avx2( c2, &bad );
+        __m256i v3 = c40_values_avx2( c3, &bad );
+        if( !_mm256_testz_si256( bad, bad ) )
+        {
+            break;
+        }
+
+        __m256i I16 = _mm256_add_epi16( _mm256_mullo_epi16( v1, _mm256_set1_epi16( 1600 ) ), _mm256_mullo_epi16( v2, _mm256_set1_epi16( 40 ) ) );
+        I16 = _mm256_add_epi16( I16, _mm256_add_epi16( v3, _mm256_set1_epi16( 1 ) ) );
+        _mm256_storeu_si256( (__m256i*)( out + done * 2 ), _mm256_shuffle_epi8( I16, C40_MASK256( c40_swap_mask ) ) );
+    }
+    return done + c40_encode_sse41( in + done * 3, triples - done, out + done * 2 );
+}
+
+/**
+ * @brief Decode 16 words per iteration, each 128-bit lane holds 8 words
+ * @return the number of words decoded, stops before the first block with a padding or invalid word
+*/
+__attribute__((target("avx2")))
+static jpro_int32 c40_decode_avx2( const jpro_byte* in, jpro_int32 words, jpro_char* out )
+{
+    jpro_int32 done = 0;
+    for( ; done + 16 <= words; done += 16 )
+    {
+        __m256i x = _mm256_shuffle_epi8( _mm256_loadu_si256( (const __m256i*)( in + done * 2 ) ), C40_MASK256( c40_swap_mask ) );
+        x = _mm256_sub_epi16( x, _mm256_set1_epi16( 1 ) );
+        __m256i u1 = _mm256_mulhi_epu16( _mm256_srli_epi16( x, 6 ), _mm256_set1_epi16( 2622 ) );      //x / 1600 = (x >> 6) / 25
+        __m256i r = _mm256_sub_epi16( x, _mm256_mullo_epi16( u1, _mm256_set1_epi16( 1600 ) ) );
+        __m256i u2 = _mm256_mulhi_epu16( _mm256_srli_epi16( r, 3 ), _mm256_set1_epi16( 13108 ) );     //r / 40 = (r >> 3) / 5
+        __m256i u3 = _mm256_sub_epi16( r, _mm256_mullo_epi16( u2, _mm256_set1_epi16( 40 ) ) );
+
+        __m256i low = _mm256_min_epu16( _mm256_min_epu16( u1, u2 ), u3 );
+        __m256i bad = _mm256_or_si256( _mm256_cmpgt_epi16( u1, _mm256_set1_epi16( 39 ) ), _mm256_cmpgt_epi16( _mm256_set1_epi16( 3 ), low ) );
+        if( !_mm256_testz_si256( bad, bad ) )
+        {
+            break;
+        }
+
+        __m256i c12 = _mm256_packus_epi16( c40_chars_avx2( u1 ), c40_chars_avx2( u2 ) );
+        __m256i c3 = _mm256_packus_epi16( c40_chars_avx2( u3 ), _mm256_setzero_si256() );
+        __m256i head = _mm256_or_si256( _mm256_shuffle_epi8( c12, C40_MASK256( c40_scatter_mask[0] ) ), _mm256_shuffle_epi8( c3, C40_MASK256( c40_scatter_mask[1] ) ) );
+        __m256i tail = _mm256_or_si256( _mm256_shuffle_epi8( c12, C40_MASK256( c40_scatter_mask[2] ) ), _mm256_shuffle_epi8( c3, C40_MASK256( c40_scatter_mask[3] ) ) );
+        jpro_char* p = out + done * 3;
+        _mm_storeu_si128( (__m128i*) p, _mm256_castsi256_si128( head ) );
+        _mm_storel_epi64( (__m128i*)( p + 16 ), _mm256_castsi256_si128( tail ) );
+        _mm_storeu_si128( (__m128i*)( p + 24 ), _mm256_extracti128_si256( head, 1 ) );
+        _mm_storel_epi64( (__m128i*)( p + 40 ), _mm256_extracti128_si256( tail, 1 ) );
+    }
+    return done + c40_decode_sse41( in + done * 2, words - done, out + done * 3 );
+}
+
+/**
+ * @brief Select the best kernels supported by the CPU, run once at program start
+*/
+__attribute__((constructor)) static void c40_select_kernels( void )
+{
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "avx2" ) )
+    {
+        c40_kernels.name = "avx2";
+        c40_kernels.encode = c40_encode_avx2;
+        c40_kernels.decode = c40_decode_avx2;
+    }
+    else if( __builtin_cpu_supports( "sse4.1" ) )
+    {
+        c40_kernels.name = "sse4.1";
+        c40_kernels.encode = c40_encode_sse41;
+        c40_kernels.decode = c40_decode_sse41;
+    }
+}
+
+#endif
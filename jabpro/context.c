@@ -0,0 +1,258 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file context.c
+ * @brief Reusable encoder and decoder contexts that keep their memory across calls
+ */
+
+#include "jabpro.h"
+#include "encoder.h"
+#include "decoder.h"
+#include "crypto.h"
+#include <string.h>
+#include <stdlib.h>
+
+/**
+ * @brief Encoder context
+*/
+struct jpro_encoder_ctx {
+	jpro_profile_info*	profiles[JPRO_PROFILE_CNT];	//the cached profile of every type, allocated in the block of profile_arena
+	jpro_arena			profile_arena;
+	jpro_byte*			buffer;						//the scratch buffer of the encoded profile
+	jpro_int32			capacity;					//the size of the buffer, the largest encoded profile of all types
+	jpro_error_state	error;						//the error of the last failed call
+};
+
+/**
+ * @brief Decoder context
+*/
+struct jpro_decoder_ctx {
+	jpro_arena			arena;		//the block the decoded profile is placed in, reset by every call
+	jpro_verify_ctx		verify;		//the reusable hash and verification state
+	jpro_error_state	error;		//the error of the last failed call
+};
+
+/**
+ * @brief Get the largest encoded profile of all profile types
+ * @return the length of the largest encoded profile without signature
+*/
+static jpro_int32 get_max_profile_size( void )
+{
+    jpro_int32 max_size = 0;
+    for( jpro_int32 type = 0; type < JPRO_PROFILE_CNT; type++ )
+    {
+        const jpro_int32 size = get_max_encoded_profile_size( get_profile_schema( type ) );
+        if( size > max_size )
+        {
+            max_size = size;
+        }
+    }
+    return max_size;
+}
+
+/**
+ * @brief Create an encoder context with a cached profile of every type and a buffer for the largest encoded profile.
+ * A context must only be used by one thread at a time.
+ * @return the context | NULL: error occurs
+*/
+jpro_encoder_ctx* jpro_create_encoder_ctx(void)
+{
+    jpro_encoder_ctx* ctx = calloc( 1, sizeof( jpro_encoder_ctx ) );
+    if( ctx == 0 )
+    {
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    ctx->error.message = "";
+    const size_t block_size = JPRO_PROFILE_CNT * ( sizeof( jpro_profile_info ) + JPRO_MAX_FEATURE_CNT * sizeof( jpro_feature_info ) + 2 * JPRO_ARENA_ALIGNMENT );
+    ctx->profile_arena.base = malloc( block_size );
+    ctx->profile_arena.capacity = block_size;
+    ctx->capacity = get_max_profile_size();
+    ctx->buffer = malloc( ctx->capacity );
+    if( ctx->profile_arena.base == 0 || ctx->buffer == 0 )
+    {
+        jpro_free_encoder_ctx( ctx );
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    for( jpro_int32 type = 0; type < JPRO_PROFILE_CNT; type++ )
+    {
+        ctx->profiles[type] = get_profile_info_arena( type, &ctx->profile_arena );
+        if( ctx->profiles[type] == 0 )
+        {
+            jpro_free_encoder_ctx( ctx );
+            return 0;
+        }
+    }
+    return ctx;
+}
+
+/**
+ * @brief Get the cached profile of a type to be filled and encoded with jpro_encode_with, the values of the previous call are kept.
+ * The values are not copied: the strings remain owned by the caller and are never freed by the context.
+ * @param ctx the encoder context
+ * @param type the profile type
+ * @return the profile owned by the context | NULL: unsupported profile type
+*/
+jpro_profile_info* jpro_encoder_ctx_profile(jpro_encoder_ctx* ctx, jpro_profile_type type)
+{
+    if( (jpro_uint32) type >= JPRO_PROFILE_CNT )
+    {
+        error_handler( "Profile type not supported", UNSUPPORTED_PROFILE_TYPE );
+        save_error_state( &ctx->error );
+        return 0;
+    }
+    return ctx->profiles[type];
+}
+
+/**
+ * @brief Encode a profile into the buffer of an encoder context without allocating memory
+ * @param ctx the encoder context
+ * @param profile_info the profile to be encoded, e.g. from jpro_encoder_ctx_profile
+ * @param[out] encoded_profile the view of the encoded profile, valid until the next call with the context
+ * @return 1: success | 0: error occurs, see jpro_encoder_ctx_error
+*/
+jpro_boolean jpro_encode_with(jpro_encoder_ctx* ctx, jpro_profile_info* profile_info, jpro_data_view* encoded_profile)
+{
+    size_t written;
+    if( encode_profile_into( profile_info, ctx->buffer, ctx->capacity, &written ) == 0 )
+    {
+        save_error_state( &ctx->error );
+        return 0;
+    }
+    encoded_profile->data = ctx->buffer;
+    encoded_profile->length = (jpro_int32) written;
+    return 1;
+}
+
+/**
+ * @brief Output the error of the last failed call with an encoder context
+ * @param ctx the encoder context
+ * @param[out] error_code the error code
+ * @return the error message
+*/
+jpro_char* jpro_encoder_ctx_error(jpro_encoder_ctx* ctx, jpro_error_code* error_code)
+{
+    return format_error_state( &ctx->error, error_code );
+}
+
+/**
+ * @brief Free an encoder context, the strings of its cached profiles are not freed
+ * @param ctx the encoder context
+*/
+void jpro_free_encoder_ctx(jpro_encoder_ctx* ctx)
+{
+    if( ctx == 0 )
+    {
+        return;
+    }
+    free( ctx->profile_arena.base );
+    free( ctx->buffer );
+    free( ctx );
+}
+
+/**
+ * @brief Create a decoder context with a memory block for the largest profile of all types.
+ * A context must only be used by one thread at a time.
+ * @return the context | NULL: error occurs
+*/
+jpro_decoder_ctx* jpro_create_decoder_ctx(void)
+{
+    jpro_decoder_ctx* ctx = calloc( 1, sizeof( jpro_decoder_ctx ) );
+    if( ctx == 0 )
+    {
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    ctx->error.message = "";
+    const jpro_int32 max_seal_size = get_max_profile_size() + 1 + get_length_tag_size( JPRO_MAX_RAW_SIGNATURE_SIZE ) + JPRO_MAX_RAW_SIGNATURE_SIZE;
+    ctx->arena.capacity = get_profile_block_size( max_seal_size );
+    ctx->arena.base = malloc( ctx->arena.capacity );
+    if( ctx->arena.base == 0 )
+    {
+        free( ctx );
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    return ctx;
+}
+
+/**
+ * @brief Decode an encoded profile into the memory of a decoder context, memory is only allocated for seals larger than any valid one
+ * @param ctx the decoder context
+ * @param encoded_profile the view of the encoded profile, it can also be a complete seal
+ * @return the decoded profile, valid until the next call with the context, it must not be freed | NULL: error occurs, see jpro_decoder_ctx_error
+*/
+jpro_profile_info* jpro_decode_with(jpro_decoder_ctx* ctx, const jpro_data_view* encoded_profile)
+{
+    const size_t block_size = get_profile_block_size( encoded_profile->length );
+    if( block_size > ctx->arena.capacity )
+    {
+        jpro_byte* base = realloc( ctx->arena.base, block_size );
+        if( base == 0 )
+        {
+            error_handler( "Out of memory", OUT_OF_MEMORY );
+            save_error_state( &ctx->error );
+            return 0;
+        }
+        ctx->arena.base = base;
+        ctx->arena.capacity = block_size;
+    }
+    ctx->arena.used = 0;
+    jpro_profile_info* decoded_profile = decode_profile_arena( encoded_profile, 0, 0, &ctx->arena );
+    if( decoded_profile == 0 )
+    {
+        save_error_state( &ctx->error );
+    }
+    return decoded_profile;
+}
+
+/**
+ * @brief Verify the signature of a seal reusing the hash and verification state of a decoder context
+ * @param ctx the decoder context
+ * @param seal the view of the seal
+ * @param public_key the public key of the document signer
+ * @return 1: the signature is valid | 0: invalid signature or error occurs, see jpro_decoder_ctx_error
+*/
+jpro_boolean jpro_verify_with(jpro_decoder_ctx* ctx, const jpro_data_view* seal, jpro_key* public_key)
+{
+    jpro_header_view header;
+    if( jpro_peek_header( seal->data, seal->length, &header ) == 0 ||
+        verify_seal_status( seal, &header, public_key, &ctx->verify, 0 ) != JPRO_SEAL_VALID )
+    {
+        save_error_state( &ctx->error );
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Output the error of the last failed call with a decoder context
+ * @param ctx the decoder context
+ * @param[out] error_code the error code
+ * @return the error message
+*/
+jpro_char* jpro_decoder_ctx_error(jpro_decoder_ctx* ctx, jpro_error_code* error_code)
+{
+    return format_error_state( &ctx->error, error_code );
+}
+
+/**
+ * @brief Free a decoder context and the profile decoded last
+ * @param ctx the decoder context
+*/
+void jpro_free_decoder_ctx(jpro_decoder_ctx* ctx)
+{
+    if( ctx == 0 )
+    {
+        return;
+    }
+    free( ctx->arena.base );
+    free_verify_ctx( &ctx->verify );
+    free( ctx );
+}
@@ -0,0 +1,462 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file crypto.c
+ * @brief Signing and verification of seals with OpenSSL (libcrypto)
+ */
+
+#include "jabpro.h"
+#include "encoder.h"
+#include "crypto.h"
+#include "batch.h"
+#include <string.h>
+#include <stdlib.h>
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+/**
+ * @brief Batch of seals to be verified
+*/
+typedef struct {
+    jpro_data**             seals;
+    const jpro_trust_store* store;
+    jpro_verify_status*     status;
+    jpro_error_code*        errors;
+    jpro_verify_ctx         ctx[JPRO_BATCH_MAX_THREAD_CNT];     //the reusable hash and verification state of every worker
+}jpro_seal_batch;
+
+/**
+ * @brief Read a key in one of the supported formats
+ * @param data the key data
+ * @param length the length of the key data
+ * @param format the index of the format to try
+ * @param[out] has_private True if a private key was read
+ * @return the key | NULL: the data is not in this format
+*/
+static EVP_PKEY* read_key( const jpro_byte* data, size_t length, jpro_int32 format, jpro_boolean* has_private )
+{
+    EVP_PKEY* pkey = 0;
+    X509* certificate = 0;
+    BIO* bio = BIO_new_mem_buf( data, length );
+    if( bio == 0 )
+    {
+        return 0;
+    }
+    *has_private = format == 0 || format == 3;
+    switch( format )
+    {
+        case 0: pkey = PEM_read_bio_PrivateKey( bio, 0, 0, 0 ); break;
+        case 1: pkey = PEM_read_bio_PUBKEY( bio, 0, 0, 0 ); break;
+        case 2: certificate = PEM_read_bio_X509( bio, 0, 0, 0 ); break;
+        case 3: pkey = d2i_PrivateKey_bio( bio, 0 ); break;
+        case 4: pkey = d2i_PUBKEY_bio( bio, 0 ); break;
+        case 5: certificate = d2i_X509_bio( bio, 0 ); break;
+    }
+    if( certificate != 0 )
+    {
+        pkey = X509_get_pubkey( certificate );
+        X509_free( certificate );
+    }
+    BIO_free( bio );
+    return pkey;
+}
+
+/**
+ * @brief Load a private key, a public key or a certificate, PEM or DER encoded
+ * @param data the key data
+ * @param length the length of the key data
+ * @return the key, to be released with jpro_free_key | NULL: error occurs
+*/
+jpro_key* jpro_load_key(const jpro_byte* data, size_t length)
+{
+    jpro_key* key = malloc( sizeof( jpro_key ) );
+    if( key == 0 )
+    {
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    key->pkey = 0;
+    for( jpro_int32 format = 0; format < 6 && key->pkey == 0; format++ )
+    {
+        key->pkey = read_key( data, length, format, &key->has_private );
+    }
+    ERR_clear_error();                                                      //failures of the formats that did not match
+    if( key->pkey == 0 )
+    {
+        free( key );
+        error_handler( "Invalid key", WRONG_INPUT );
+        return 0;
+    }
+    if( EVP_PKEY_get_utf8_string_param( key->pkey, OSSL_PKEY_PARAM_GROUP_NAME, key->curve, sizeof( key->curve ), 0 ) == 0 )
+    {
+        jpro_free_key( key );
+        error_handler( "Invalid key: not an elliptic curve key", WRONG_INPUT );
+        return 0;
+    }
+    return key;
+}
+
+/**
+ * @brief Free a key
+ * @param key the key
+*/
+void jpro_free_key(jpro_key* key)
+{
+    if( key == 0 )
+    {
+        return;
+    }
+    EVP_PKEY_free( key->pkey );
+    free( key );
+}
+
+/**
+ * @brief Get the hash and signature algorithm of a profile that match the curve of a key
+ * @param type the profile type
+ * @param key the key
+ * @param[out] hash_algo the hash algorithm
+ * @param[out] signature_algo the signature algorithm
+ * @return 1: success | 0: error occurs
+*/
+jpro_boolean get_signature_algos( jpro_profile_type type, const jpro_key* key, const jpro_crypto_algo** hash_algo, const jpro_crypto_algo** signature_algo )
+{
+    const jpro_profile_schema* schema = get_profile_schema( type );
+    if( schema == 0 )
+    {
+        return 0;
+    }
+    const jpro_crypto_info* crypto = schema->crypto;
+    for( jpro_int32 i = 0; i < crypto->signature_algo_cnt; i++ )
+    {
+        if( strcmp( crypto->signature_algos[i].algo, key->curve ) == 0 )
+        {
+            *signature_algo = &crypto->signature_algos[i];
+            *hash_algo = &crypto->hash_algos[i < crypto->hash_algo_cnt ? i : 0];
+            return 1;
+        }
+    }
+    error_handler_detail( "Key does not match the signature algorithm of the profile: ", key->curve, WRONG_INPUT );
+    return 0;
+}
+
+/**
+ * @brief Hash data
+ * @param ctx the hash state to reuse | NULL: one-shot
+ * @param hash_algo the hash algorithm
+ * @param data the data
+ * @param length the length of the data
+ * @param[out] digest the digest, at least JPRO_MAX_DIGEST_SIZE bytes
+ * @return the length of the digest | 0: error occurs
+*/
+jpro_int32 get_digest( jpro_verify_ctx* ctx, const jpro_crypto_algo* hash_algo, const jpro_byte* data, size_t length, jpro_byte* digest )
+{
+    const EVP_MD* md = hash_algo->size == 224 ? EVP_sha224() :
+                       hash_algo->size == 256 ? EVP_sha256() :
+                       hash_algo->size == 384 ? EVP_sha384() :
+                       hash_algo->size == 512 ? EVP_sha512() : 0;
+    unsigned int digest_length = 0;
+    jpro_boolean success = 0;
+    if( md != 0 && ctx == 0 )
+    {
+        success = EVP_Digest( data, length, digest, &digest_length, md, 0 );
+    }
+    else if( md != 0 )
+    {
+        if( ctx->md_ctx == 0 )
+        {
+            ctx->md_ctx = EVP_MD_CTX_new();
+        }
+        success = ctx->md_ctx != 0 && EVP_DigestInit_ex( ctx->md_ctx, md, 0 ) &&
+                  EVP_DigestUpdate( ctx->md_ctx, data, length ) && EVP_DigestFinal_ex( ctx->md_ctx, digest, &digest_length );
+    }
+    if( success == 0 )
+    {
+        error_handler( "Hashing failed", CRYPTO_FAILED );
+        return 0;
+    }
+    return digest_length;
+}
+
+/**
+ * @brief Sign a digest with ECDSA
+ * @param key the private key
+ * @param digest the digest
+ * @param digest_length the length of the digest
+ * @param[out] signature the raw signature r||s
+ * @param signature_length the length of the raw signature, r and s take half of it each
+ * @return 1: success | 0: error occurs
+*/
+jpro_boolean sign_digest( const jpro_key* key, const jpro_byte* digest, jpro_int32 digest_length, jpro_byte* signature, jpro_int32 signature_length )
+{
+    if( key->has_private == 0 )
+    {
+        error_handler( "Signing failed: no private key", WRONG_INPUT );
+        return 0;
+    }
+    jpro_byte der_signature[JPRO_DER_SIGNATURE_SIZE( JPRO_MAX_RAW_SIGNATURE_SIZE )];
+    size_t der_length = sizeof( der_signature );
+    jpro_boolean success = 0;
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new( key->pkey, 0 );
+    if( ctx != 0 && EVP_PKEY_sign_init( ctx ) > 0 && EVP_PKEY_sign( ctx, der_signature, &der_length, digest, digest_length ) > 0 )
+    {
+        success = jpro_signature_der_to_raw( der_signature, der_length, signature, signature_length ) != 0;
+    }
+    EVP_PKEY_CTX_free( ctx );
+    if( success == 0 )
+    {
+        ERR_clear_error();
+        error_handler( "Signing failed", CRYPTO_FAILED );
+    }
+    return success;
+}
+
+/**
+ * @brief Verify the ECDSA signature of a digest
+ * @param ctx the verification state to reuse | NULL: one-shot
+ * @param key the public key
+ * @param digest the digest
+ * @param digest_length the length of the digest
+ * @param signature the raw signature r||s
+ * @param signature_length the length of the raw signature
+ * @return 1: valid | 0: invalid signature or error occurs
+*/
+jpro_boolean verify_digest( jpro_verify_ctx* ctx, const jpro_key* key, const jpro_byte* digest, jpro_int32 digest_length, const jpro_byte* signature, jpro_int32 signature_length )
+{
+    jpro_byte der_signature[JPRO_DER_SIGNATURE_SIZE( JPRO_MAX_RAW_SIGNATURE_SIZE )];
+    const jpro_int32 der_length = jpro_signature_raw_to_der( signature, signature_length, der_signature, sizeof( der_signature ) );
+    if( der_length == 0 )
+    {
+        return 0;
+    }
+
+    jpro_verify_ctx one_shot = { 0, 0 };
+    if( ctx == 0 )
+    {
+        ctx = &one_shot;
+    }
+    //seals of the same signer reuse the initialized state, the state holds a reference to its key so the address cannot be reused by another key
+    if( ctx->pkey_ctx == 0 || EVP_PKEY_CTX_get0_pkey( ctx->pkey_ctx ) != key->pkey )
+    {
+        EVP_PKEY_CTX_free( ctx->pkey_ctx );
+        ctx->pkey_ctx = EVP_PKEY_CTX_new( key->pkey, 0 );
+        if( ctx->pkey_ctx != 0 && EVP_PKEY_verify_init( ctx->pkey_ctx ) <= 0 )
+        {
+            EVP_PKEY_CTX_free( ctx->pkey_ctx );
+            ctx->pkey_ctx = 0;
+        }
+    }
+    jpro_int32 result = -1;
+    if( ctx->pkey_ctx != 0 )
+    {
+        result = EVP_PKEY_verify( ctx->pkey_ctx, der_signature, der_length, digest, digest_length );
+    }
+    if( ctx == &one_shot )
+    {
+        EVP_PKEY_CTX_free( one_shot.pkey_ctx );
+    }
+    ERR_clear_error();
+    if( result == 0 )
+    {
+        error_handler( "Invalid signature", INVALID_SIGNATURE );
+        return 0;
+    }
+    if( result < 0 )
+    {
+        error_handler( "Verification failed", CRYPTO_FAILED );
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Sign an encoded profile with ECDSA using the hash and signature algorithm of its profile
+ * @param encoded_profile the encoded profile
+ * @param private_key the private key, its curve selects the signature algorithm of the profile
+ * @return the seal with the appended raw signature r||s | NULL: error occurs
+*/
+jpro_data* jpro_sign_profile(jpro_data* encoded_profile, jpro_key* private_key)
+{
+    jpro_header_view header;
+    if( jpro_peek_header( encoded_profile->data, encoded_profile->length, &header ) == 0 )
+    {
+        return 0;
+    }
+    const jpro_crypto_algo* hash_algo;
+    const jpro_crypto_algo* signature_algo;
+    if( get_signature_algos( header.type, private_key, &hash_algo, &signature_algo ) == 0 )
+    {
+        return 0;
+    }
+    jpro_byte digest[JPRO_MAX_DIGEST_SIZE];
+    const jpro_int32 digest_length = get_digest( 0, hash_algo, encoded_profile->data, encoded_profile->length, digest );
+    if( digest_length == 0 )
+    {
+        return 0;
+    }
+
+    const jpro_int32 signature_length = ( signature_algo->size + 7 ) / 8;  //the size is given in bits
+    jpro_data* signature = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * signature_length );
+    if( signature == 0 )
+    {
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    signature->length = signature_length;
+    jpro_data* seal = 0;
+    if( sign_digest( private_key, digest, digest_length, signature->data, signature_length ) )
+    {
+        seal = append_signature( encoded_profile, signature );
+    }
+    free( signature );
+    return seal;
+}
+
+/**
+ * @brief Free the hash and verification state of a thread
+ * @param ctx the state
+*/
+void free_verify_ctx( jpro_verify_ctx* ctx )
+{
+    EVP_MD_CTX_free( ctx->md_ctx );
+    EVP_PKEY_CTX_free( ctx->pkey_ctx );
+    ctx->md_ctx = 0;
+    ctx->pkey_ctx = 0;
+}
+
+/**
+ * @brief Verify the signature of a seal and report why it fails
+ * @param seal the seal
+ * @param header the header of the seal read by jpro_peek_header
+ * @param key the public key of the document signer
+ * @param ctx the verification state to reuse | NULL: one-shot
+ * @param check_validity True to check that the algorithms were valid in the year of the signature date
+ * @return the verification status, the error is set for all but JPRO_SEAL_VALID
+*/
+jpro_verify_status verify_seal_status( const jpro_data_view* seal, const jpro_header_view* header, const jpro_key* key, jpro_verify_ctx* ctx, jpro_boolean check_validity )
+{
+    const jpro_crypto_algo* hash_algo;
+    const jpro_crypto_algo* signature_algo;
+    if( get_signature_algos( header->type, key, &hash_algo, &signature_algo ) == 0 )
+    {
+        return JPRO_SEAL_BAD_SIGNATURE;
+    }
+    jpro_data_view encoded_profile;
+    jpro_data_view signature;
+    if( parse_seal_view( seal, ( signature_algo->size + 7 ) / 8, &encoded_profile, &signature ) == 0 )
+    {
+        return JPRO_SEAL_BAD_STRUCTURE;
+    }
+
+    jpro_verify_status status = JPRO_SEAL_BAD_SIGNATURE;
+    jpro_byte digest[JPRO_MAX_DIGEST_SIZE];
+    const jpro_int32 digest_length = get_digest( ctx, hash_algo, encoded_profile.data, encoded_profile.length, digest );    //hashed in place in the seal
+    if( digest_length != 0 && verify_digest( ctx, key, digest, digest_length, signature.data, signature.length ) )
+    {
+        status = JPRO_SEAL_VALID;
+    }
+
+    const jpro_int32 year = header->signature_date / 10000;
+    if( status == JPRO_SEAL_VALID && check_validity &&
+        ( year < signature_algo->valid_from || year >= signature_algo->valid_till || year < hash_algo->valid_from || year >= hash_algo->valid_till ) )
+    {
+        error_handler_detail( "Algorithm not valid at the signature date: ", signature_algo->algo, EXPIRED_ALGORITHM );
+        status = JPRO_SEAL_EXPIRED_ALGORITHM;
+    }
+    return status;
+}
+
+/**
+ * @brief Verify the signature of a seal with the hash and signature algorithm of its profile
+ * @param seal the seal
+ * @param public_key the public key of the document signer, its curve selects the signature algorithm of the profile
+ * @return 1: valid signature | 0: invalid signature (INVALID_SIGNATURE) or error occurs
+*/
+jpro_boolean jpro_verify_seal(jpro_data* seal, jpro_key* public_key)
+{
+    const jpro_data_view view = { seal->data, seal->length };
+    return jpro_verify_seal_view( &view, public_key );
+}
+
+/**
+ * @brief Verify the signature of a seal in a buffer owned by the caller, nothing is copied
+ * @param seal the view of the seal
+ * @param public_key the public key of the document signer, its curve selects the signature algorithm of the profile
+ * @return 1: valid signature | 0: invalid signature (INVALID_SIGNATURE) or error occurs
+*/
+jpro_boolean jpro_verify_seal_view(const jpro_data_view* seal, jpro_key* public_key)
+{
+    jpro_header_view header;
+    if( jpro_peek_header( seal->data, seal->length, &header ) == 0 )
+    {
+        return 0;
+    }
+    return verify_seal_status( seal, &header, public_key, 0, 0 ) == JPRO_SEAL_VALID;
+}
+
+/**
+ * @brief Verify a single seal of a batch
+ * @param context the batch
+ * @param worker the index of the worker thread
+ * @param index the index of the seal
+*/
+static void verify_batch_item( void* context, jpro_int32 worker, size_t index )
+{
+    jpro_seal_batch* batch = context;
+    const jpro_data_view seal = { batch->seals[index]->data, batch->seals[index]->length };
+    jpro_header_view header;
+    jpro_verify_status status = JPRO_SEAL_BAD_STRUCTURE;
+    if( jpro_peek_header( seal.data, seal.length, &header ) )
+    {
+        const jpro_key* key = jpro_trust_store_find( batch->store, header.signer_country, header.signer_id, header.certificate_ref );
+        status = key == 0 ? JPRO_SEAL_UNKNOWN_SIGNER : verify_seal_status( &seal, &header, key, &batch->ctx[worker], 1 );
+    }
+    batch->status[index] = status;
+    if( status != JPRO_SEAL_VALID && batch->errors != 0 )
+    {
+        batch->errors[index] = get_last_error_code();
+    }
+}
+
+/**
+ * @brief Verify seals with the keys of their document signers from a trust store on a pool of threads.
+ * Every thread keeps its hash and verification state across the seals it verifies.
+ * @param[in]  seals the seals to be verified
+ * @param[in]  seal_cnt the number of seals
+ * @param[in]  store the trust store, shared by all threads
+ * @param[out] status the verification status of every seal
+ * @param[in]  opts the batch options | NULL: default options
+ * @return the number of valid seals
+*/
+size_t jpro_verify_batch(jpro_data** seals, size_t seal_cnt, const jpro_trust_store* store, jpro_verify_status* status, jpro_batch_opts* opts)
+{
+    jpro_seal_batch* batch = calloc( 1, sizeof( jpro_seal_batch ) );
+    if( batch == 0 )
+    {
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    batch->seals = seals;
+    batch->store = store;
+    batch->status = status;
+    batch->errors = opts ? opts->errors : 0;
+    run_batch( seal_cnt, opts ? opts->thread_cnt : 0, verify_batch_item, batch );
+    for( jpro_int32 i = 0; i < JPRO_BATCH_MAX_THREAD_CNT; i++ )
+    {
+        free_verify_ctx( &batch->ctx[i] );
+    }
+    free( batch );
+
+    size_t valid_cnt = 0;
+    for( size_t i = 0; i < seal_cnt; i++ )
+    {
+        valid_cnt += status[i] == JPRO_SEAL_VALID;
+    }
+    return valid_cnt;
+}
@@ -0,0 +1,45 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file crypto.h
+ * @brief Signing and verification header
+ */
+
+#ifndef JABPRO_CRYPTO_H
+#define JABPRO_CRYPTO_H
+
+#include <openssl/evp.h>
+
+#define JPRO_MAX_CURVE_NAME_LENGTH  32
+#define JPRO_MAX_DIGEST_SIZE        EVP_MAX_MD_SIZE
+
+/**
+ * @brief Signing or verification key
+*/
+struct jpro_key {
+	EVP_PKEY*		pkey;
+	jpro_char		curve[JPRO_MAX_CURVE_NAME_LENGTH];	//the name of the curve, e.g. brainpoolP256r1
+	jpro_boolean	has_private;						//True if the key can sign
+};
+
+/**
+ * @brief Reusable hash and verification state of a thread
+*/
+typedef struct {
+	EVP_MD_CTX*		md_ctx;
+	EVP_PKEY_CTX*	pkey_ctx;		//initialized for verification with the key it holds
+}jpro_verify_ctx;
+
+extern jpro_boolean get_signature_algos( jpro_profile_type type, const jpro_key* key, const jpro_crypto_algo** hash_algo, const jpro_crypto_algo** signature_algo );
+extern jpro_int32 get_digest( jpro_verify_ctx* ctx, const jpro_crypto_algo* hash_algo, const jpro_byte* data, size_t length, jpro_byte* digest );
+extern jpro_boolean sign_digest( const jpro_key* key, const jpro_byte* digest, jpro_int32 digest_length, jpro_byte* signature, jpro_int32 signature_length );
+extern jpro_boolean verify_digest( jpro_verify_ctx* ctx, const jpro_key* key, const jpro_byte* digest, jpro_int32 digest_length, const jpro_byte* signature, jpro_int32 signature_length );
+extern jpro_verify_status verify_seal_status( const jpro_data_view* seal, const jpro_header_view* header, const jpro_key* key, jpro_verify_ctx* ctx, jpro_boolean check_validity );
+extern void free_verify_ctx( jpro_verify_ctx* ctx );
+
+#endif
@@ -19,6 +19,33 @@
 #include <math.h>
 #include <string.h>
 
+/**
+ * @brief Get the length of the certificate reference from the two hex digits of a version 4 header
+ * @param digits the two digits
+ * @return the length | -1: invalid digits
+*/
+static jpro_int32 get_cert_ref_length( const jpro_char* digits )
+{
+    jpro_int32 length = 0;
+    for( jpro_int32 i = 0; i < 2; i++ )
+    {
+        const jpro_char c = digits[i];
+        if( c >= '0' && c <= '9' )
+        {
+            length = length * 16 + c - '0';
+        }
+        else if( c >= 'A' && c <= 'F' )
+        {
+            length = length * 16 + c - 'A' + 10;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return length;
+}
+
 /**
  * @brief Decode an encoded profile header
  * @param[in]  seal the seal whose header is to be decoded, it can also be an encoded profile without the signature
@@ -27,7 +54,8 @@
 */
 jpro_header_info* decode_header(jpro_data* seal, jpro_profile_type* type)
 {
-	return decode_profile_header(seal, type, 0);
+	const jpro_data_view view = { seal->data, seal->length };
+	return decode_profile_header(&view, type, 0, 0);
 }
 
 /**
@@ -35,10 +63,22 @@ jpro_header_info* decode_header(jpro_data* seal, jpro_profile_type* type)
  * @param[in]  seal the seal whose header is to be decoded, it can also be an encoded profile without the signature
  * @param[out] type the profile type of the input seal
  * @param[out] header_length the header length in bytes
+ * @param[in]  arena the arena the decoded header is allocated in | NULL: allocate on the heap
  * @return the decoded header | NULL: error occurs
 */
-jpro_header_info* decode_profile_header(jpro_data* seal, jpro_profile_type* type, jpro_int32* header_length)
+jpro_header_info* decode_profile_header(const jpro_data_view* seal, jpro_profile_type* type, jpro_int32* header_length, jpro_arena* arena)
 {
+	//the fixed fields and the minimal certificate reference must fit, the version 4 reference is checked below
+	if( seal->length < JPRO_MIN_HEADER_LENGTH )
+	{
+		if( seal->length >= 2 && seal->data[0] == 0xDC && seal->data[1] != 0x02 && seal->data[1] != 0x03 )
+		{
+			error_handler( "Unsupported header version", UNSUPPORTED_HEADER_VERSION );
+			return 0;
+		}
+		error_handler( "Invalid header", INVALID_HEADER );
+		return 0;
+	}
 	//reading position
 	jpro_int32 pos = 0;
 	//magic constant
@@ -55,7 +95,7 @@ jpro_header_info* decode_profile_header(jpro_data* seal, jpro_profile_type* type
         return 0;
 	}
 
-    jpro_header_info* decoded_header = malloc( sizeof( jpro_header_info ) );
+    jpro_header_info* decoded_header = arena_alloc( arena, sizeof( jpro_header_info ) );
     if( decoded_header == 0 )
     {
         error_handler( "Out of memory", OUT_OF_MEMORY );
@@ -63,42 +103,30 @@ jpro_header_info* decode_profile_header(jpro_data* seal, jpro_profile_type* type
     }
 
 	//issuing country
-    jpro_data* issuing_country_enc = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * 2 );
-    if( issuing_country_enc == 0 )
+    decoded_header->issuing_country = arena_alloc( arena, sizeof( jpro_char ) * ( C40_DECODED_LENGTH( 2 ) + 1 ) );
+    if( decoded_header->issuing_country == 0 )
     {
         error_handler( "Out of memory", OUT_OF_MEMORY );
         return 0;
     }
-    issuing_country_enc->length = 2;
-    issuing_country_enc->data[0] = seal->data[pos++];
-    issuing_country_enc->data[1] = seal->data[pos++];
-    decoded_header->issuing_country = c40_decode( issuing_country_enc );
-    if( decoded_header->issuing_country == 0 )
+    if( c40_decode_into( seal->data + pos, 2, decoded_header->issuing_country ) == 0 )
     {
-        return 0;       //error handled in c40_decode
+        return 0;       //error handled in c40_decode_into
     }
-	free( issuing_country_enc );
+    pos += 2;
 
     if( version == 0x02 )         //header version 3
     {
 		//decode signer identifier and certificate reference
-        jpro_data* sign_cert_ref = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * 6 );
-        if( sign_cert_ref == 0 )
-        {
-            error_handler( "Out of memory", OUT_OF_MEMORY );
-            return 0;
-        }
-        sign_cert_ref->length = 6;
-        memcpy( sign_cert_ref->data, seal->data + pos, sign_cert_ref->length );
-		pos += sign_cert_ref->length;
-        jpro_char* sign_cert_ref_dec = c40_decode( sign_cert_ref );
-        if( sign_cert_ref_dec == 0 )
+        jpro_char sign_cert_ref_dec[C40_DECODED_LENGTH( 6 ) + 1];
+        if( c40_decode_into( seal->data + pos, 6, sign_cert_ref_dec ) == 0 )
         {
-            return 0;       //error handled in c40_decode
+            return 0;       //error handled in c40_decode_into
         }
-        decoded_header->signer_country = malloc( sizeof( jpro_char ) * 3 );
-        decoded_header->signer_id = malloc( sizeof( jpro_char ) * 3 );
-        decoded_header->certificate_ref = malloc( sizeof( jpro_char ) * 6 );
+		pos += 6;
+        decoded_header->signer_country = arena_alloc( arena, sizeof( jpro_char ) * 3 );
+        decoded_header->signer_id = arena_alloc( arena, sizeof( jpro_char ) * 3 );
+        decoded_header->certificate_ref = arena_alloc( arena, sizeof( jpro_char ) * 6 );
         if( decoded_header->signer_country == 0 || decoded_header->signer_id == 0 || decoded_header->certificate_ref == 0 )
         {
             error_handler( "Out of memory" , OUT_OF_MEMORY );
@@ -107,28 +135,18 @@ jpro_header_info* decode_profile_header(jpro_data* seal, jpro_profile_type* type
         snprintf( decoded_header->signer_country, 3, "%c%c", sign_cert_ref_dec[0], sign_cert_ref_dec[1] );
         snprintf( decoded_header->signer_id, 3, "%c%c", sign_cert_ref_dec[2], sign_cert_ref_dec[3] );
 		snprintf( decoded_header->certificate_ref, 6, "%s", sign_cert_ref_dec + 4);
-		free( sign_cert_ref );
-		free( sign_cert_ref_dec );
     }
     else if( version == 0x03 )    //header version 4
     {
 		//decode signer identifier + the length of certificate reference
-		jpro_data* sign_ref = malloc( sizeof(jpro_data) + sizeof(jpro_byte) * 4 );
-		if( sign_ref == 0 )
-		{
-			error_handler( "Out of memory", OUT_OF_MEMORY );
-            return 0;
-		}
-		sign_ref->length = 4;
-		memcpy(sign_ref->data, seal->data + pos, sign_ref->length);
-		pos += sign_ref->length;
-		jpro_char* sign_ref_dec = c40_decode( sign_ref );
-		if( sign_ref_dec == 0 )
+		jpro_char sign_ref_dec[C40_DECODED_LENGTH( 4 ) + 1];
+		if( c40_decode_into( seal->data + pos, 4, sign_ref_dec ) == 0 )
 		{
 			return 0;
 		}
-		decoded_header->signer_country = malloc( sizeof( jpro_char ) * 3 );
-        decoded_header->signer_id = malloc( sizeof( jpro_char ) * 3 );
+		pos += 4;
+		decoded_header->signer_country = arena_alloc( arena, sizeof( jpro_char ) * 3 );
+        decoded_header->signer_id = arena_alloc( arena, sizeof( jpro_char ) * 3 );
 		if( decoded_header->signer_country == 0 || decoded_header->signer_id == 0)
         {
             error_handler( "Out of memory" , OUT_OF_MEMORY );
@@ -136,38 +154,42 @@ jpro_header_info* decode_profile_header(jpro_data* seal, jpro_profile_type* type
         }
         snprintf( decoded_header->signer_country, 3, "%c%c", sign_ref_dec[0], sign_ref_dec[1] );
         snprintf( decoded_header->signer_id, 3, "%c%c", sign_ref_dec[2], sign_ref_dec[3] );
-		jpro_int32 cert_ref_length = (sign_ref_dec[4]-48) * 16 + (sign_ref_dec[5]-48);	//get the length of certificate reference
-		free( sign_ref );
-		free( sign_ref_dec );
+		jpro_int32 cert_ref_length = get_cert_ref_length( sign_ref_dec + 4 );	//get the length of certificate reference
+		if( cert_ref_length <= 0 )
+		{
+			error_handler( "Invalid header", INVALID_HEADER );
+			return 0;
+		}
 
 		//decode certiface reference
-		jpro_int32 cert_ref_c40_length = (cert_ref_length/3 + cert_ref_length%3 > 0 ? 1 : 0 ) * 2;
-		jpro_data* cert_ref_enc = malloc( sizeof(jpro_data) + sizeof(jpro_byte) * cert_ref_c40_length );
-		if( cert_ref_enc == 0 )
+		jpro_int32 cert_ref_c40_length = C40_ENCODED_LENGTH( cert_ref_length );
+		if( seal->length < JPRO_MIN_HEADER_LENGTH - 2 + cert_ref_c40_length )	//the minimum counts a 2-byte certificate reference
+		{
+			error_handler( "Invalid header", INVALID_HEADER );
+			return 0;
+		}
+		decoded_header->certificate_ref = arena_alloc( arena, sizeof( jpro_char ) * ( C40_DECODED_LENGTH( cert_ref_c40_length ) + 1 ) );
+		if( decoded_header->certificate_ref == 0 )
 		{
 			error_handler( "Out of memory", OUT_OF_MEMORY );
             return 0;
 		}
-		cert_ref_enc->length = cert_ref_c40_length;
-		memcpy(cert_ref_enc->data, seal->data + pos, cert_ref_enc->length);
-		pos += cert_ref_enc->length;
-		decoded_header->certificate_ref = c40_decode( cert_ref_enc );
-		if( decoded_header->certificate_ref == 0 )
+		if( c40_decode_into( seal->data + pos, cert_ref_c40_length, decoded_header->certificate_ref ) == 0 )
 		{
 			return 0;
 		}
-		free(cert_ref_enc);
+		pos += cert_ref_c40_length;
     }
 
 	//decode document issue date
-	decoded_header->issue_date = date_decode( seal->data + pos );
+	decoded_header->issue_date = date_decode( seal->data + pos, arena );
 	pos += 3;
 	if( strcmp( decoded_header->issue_date.day, "" ) == 0 )
 	{
 		return 0;       //error handled in date_decode
 	}
 	//decode signature creation date
-	decoded_header->signature_date = date_decode( seal->data + pos );
+	decoded_header->signature_date = date_decode( seal->data + pos, arena );
 	pos += 3;
 	if( strcmp( decoded_header->signature_date.day, "" ) == 0 )
 	{
@@ -179,39 +201,12 @@ jpro_header_info* decode_profile_header(jpro_data* seal, jpro_profile_type* type
 	jpro_byte document_type = seal->data[pos++];
 
 	//set profile type
-	if( version == 0x02 && feature_ref == 0xFD && document_type == 0x02 )
-	{
-		*type = JPRO_ARRIVAL_ATTESTATION_DOCUMENT;
-	}
-	else if( version == 0x02 && feature_ref == 0xFC && document_type == 0x04 )
-	{
-		*type = JPRO_SOCIAL_INSURANCE_CARD;
-	}
-	else if( version == 0x03 && feature_ref == 0x5D && document_type == 0x01 )
-	{
-		*type = JPRO_VISA;
-	}
-	else if( version == 0x03 && feature_ref == 0xFB && document_type == 0x06 )
-	{
-		*type = JPRO_RESIDENCE_PERMIT;
-	}
-	else if( version == 0x03 && feature_ref == 0xFA && document_type == 0x06 )
-    {
-        *type = JPRO_SUPPLEMENTARY_SHEET;
-    }
-	else if( version == 0x03 && feature_ref == 0xF9 && document_type == 0x08 )
-	{
-		*type = JPRO_ADDRESS_STICKER_FOR_ID_CARD;
-	}
-	else if( version == 0x03 && feature_ref == 0xF8 && document_type == 0x0A )
-	{
-		*type = JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT;
-	}
-	else
+	const jpro_profile_schema* schema = get_profile_schema_by_id( version, feature_ref, document_type );
+	if( schema == 0 )
 	{
-		error_handler( "Unknown profile type in header", UNKNOWN_PROFILE_TYPE );
 		return 0;
 	}
+	*type = schema->type;
 	//set the header length
 	if(header_length)
 	{
@@ -222,39 +217,277 @@ jpro_header_info* decode_profile_header(jpro_data* seal, jpro_profile_type* type
 }
 
 /**
- * @brief Parse a seal to an encoded profile and a signature
+ * @brief Decode a date of 3 bytes into a packed integer, check it with jpro_date_is_valid if needed
+ * @param encoded_date the encoded date of 3 bytes
+ * @return the date packed as yyyymmdd, e.g. 20220209
+*/
+jpro_uint32 jpro_date_decode(const jpro_byte* encoded_date)
+{
+    const jpro_uint32 date_int = ( encoded_date[0] << 16 ) | ( encoded_date[1] << 8 ) | encoded_date[2];     //mmddyyyy
+    return ( date_int % 10000 ) * 10000 + ( date_int / 1000000 ) * 100 + ( date_int / 10000 ) % 100;
+}
+
+/**
+ * @brief Write the decimal digits of a number with leading zeros
+ * @param value the number
+ * @param digit_cnt the number of digits
+ * @param[out] out the output buffer of digit_cnt + 1 characters, terminated with '\0'
+*/
+static void write_digits( jpro_uint32 value, jpro_int32 digit_cnt, jpro_char* out )
+{
+    out[digit_cnt] = '\0';
+    for( jpro_int32 i = digit_cnt - 1; i >= 0; i-- )
+    {
+        out[i] = '0' + value % 10;
+        value /= 10;
+    }
+}
+
+/**
+ * @brief Unpack a packed date into strings without allocating memory
+ * @param date the date packed as yyyymmdd, e.g. 20220209
+ * @param[out] buffer the storage of the strings, at least JPRO_DATE_STRING_SIZE characters
+ * @return the date, its strings point into the buffer
+*/
+jpro_date jpro_date_unpack(jpro_uint32 date, jpro_char* buffer)
+{
+    jpro_date unpacked;
+    unpacked.year = buffer;
+    unpacked.month = buffer + 5;
+    unpacked.day = buffer + 8;
+    write_digits( date / 10000, 4, unpacked.year );
+    write_digits( ( date / 100 ) % 100, 2, unpacked.month );
+    write_digits( date % 100, 2, unpacked.day );
+    return unpacked;
+}
+
+/**
+ * @brief Read the header of a seal without allocating memory, e.g. to route the seal by its profile type
+ * @param[in]  seal the seal, it can also be an encoded profile without the signature
+ * @param[in]  length the length of the seal in bytes
+ * @param[out] view the header view
+ * @return 1: success | 0: error occurs
+*/
+jpro_boolean jpro_peek_header(const jpro_byte* seal, size_t length, jpro_header_view* view)
+{
+    if( length < JPRO_MIN_HEADER_LENGTH )
+    {
+        //report the same errors as decode_profile_header for seals too short for any header
+        if( length >= 2 && seal[0] == 0xDC && seal[1] != 0x02 && seal[1] != 0x03 )
+        {
+            error_handler( "Unsupported header version", UNSUPPORTED_HEADER_VERSION );
+            return 0;
+        }
+        error_handler( "Invalid header", INVALID_HEADER );
+        return 0;
+    }
+    if( seal[0] != 0xDC )
+    {
+        error_handler( "Invalid header", INVALID_HEADER );
+        return 0;
+    }
+    view->version = seal[1];
+    if( view->version != 0x02 && view->version != 0x03 )
+    {
+        error_handler( "Unsupported header version", UNSUPPORTED_HEADER_VERSION );
+        return 0;
+    }
+    if( c40_decode_into( seal + 2, 2, view->issuing_country ) == 0 )
+    {
+        return 0;
+    }
+
+    jpro_char sign_ref_dec[C40_DECODED_LENGTH( 6 ) + 1];
+    const jpro_int32 sign_ref_length = view->version == 0x02 ? 6 : 4;
+    if( c40_decode_into( seal + 4, sign_ref_length, sign_ref_dec ) == 0 )
+    {
+        return 0;
+    }
+    memcpy( view->signer_country, sign_ref_dec, 2 );
+    view->signer_country[2] = '\0';
+    memcpy( view->signer_id, sign_ref_dec + 2, 2 );
+    view->signer_id[2] = '\0';
+    jpro_int32 pos = 4 + sign_ref_length;
+    if( view->version == 0x02 )
+    {
+        memcpy( view->certificate_ref, sign_ref_dec + 4, 6 );                  //5 characters and '\0'
+    }
+    else
+    {
+        const jpro_int32 cert_ref_length = get_cert_ref_length( sign_ref_dec + 4 );
+        if( cert_ref_length <= 0 )
+        {
+            error_handler( "Invalid header", INVALID_HEADER );
+            return 0;
+        }
+        const jpro_int32 cert_ref_c40_length = C40_ENCODED_LENGTH( cert_ref_length );
+        if( length < (size_t) ( JPRO_MIN_HEADER_LENGTH - 2 + cert_ref_c40_length ) )    //the minimum counts a 2-byte certificate reference
+        {
+            error_handler( "Invalid header", INVALID_HEADER );
+            return 0;
+        }
+        if( c40_decode_into( seal + pos, cert_ref_c40_length, view->certificate_ref ) == 0 )
+        {
+            return 0;
+        }
+        view->certificate_ref[cert_ref_length] = '\0';                         //drop the padding of the last C40 word
+        pos += cert_ref_c40_length;
+    }
+
+    view->issue_date = jpro_date_decode( seal + pos );
+    view->signature_date = jpro_date_decode( seal + pos + 3 );
+    const jpro_profile_schema* schema = get_profile_schema_by_id( view->version, seal[pos + 6], seal[pos + 7] );
+    if( schema == 0 )
+    {
+        return 0;
+    }
+    view->type = schema->type;
+    view->header_length = pos + 8;
+    return 1;
+}
+
+/**
+ * @brief Rule of every tag in the message zone of every profile: the index of the rule in the schema + 1 ( 0: unknown tag )
+*/
+static jpro_byte jpro_tag_rules[JPRO_PROFILE_CNT][256];
+
+/**
+ * @brief Fill the tag dispatch table from the TLV rules of the schemas, run once at program start
+*/
+__attribute__((constructor)) static void build_tag_rules( void )
+{
+    for( jpro_int32 type = 0; type < JPRO_PROFILE_CNT; type++ )
+    {
+        const jpro_profile_schema* schema = get_profile_schema( type );
+        for( jpro_int32 r = 0; r < schema->rule_cnt; r++ )
+        {
+            jpro_tag_rules[type][schema->rules[r].tag] = r + 1;
+        }
+    }
+}
+
+/**
+ * @brief Get the TLV rule of a tag
+ * @param schema the schema of the profile
+ * @param tag the tag
+ * @return the rule | NULL: unknown tag
+*/
+static const jpro_tlv_rule* get_tlv_rule( const jpro_profile_schema* schema, jpro_byte tag )
+{
+    const jpro_byte rule = jpro_tag_rules[schema->type][tag];
+    return rule != 0 ? &schema->rules[rule - 1] : 0;
+}
+
+/**
+ * @brief Read a TLV of the message zone without decoding its value
+ * @param[in] encoded_profile the encoded profile
+ * @param[in] schema the schema of the profile
+ * @param[in] pos the position of the tag
+ * @param[out] view the view of the value
+ * @return the position of the next tag | 0: error occurs
+*/
+static jpro_int32 read_tlv( const jpro_data_view* encoded_profile, const jpro_profile_schema* schema, jpro_int32 pos, jpro_feature_view* view )
+{
+    view->tag = encoded_profile->data[pos++];
+    if( pos >= encoded_profile->length )
+    {
+        error_handler( "Invalid length tag", INVALID_LENGTH_TAG );
+        return 0;
+    }
+    jpro_int32 length = encoded_profile->data[pos];
+    if( schema->der_length && length >= 128 )
+    {
+        if( length == 128 || length > 132 || pos + length - 128 >= encoded_profile->length )
+        {
+            error_handler( "Invalid length tag", INVALID_LENGTH_TAG );
+            return 0;
+        }
+        length = read_length_tag( encoded_profile, &pos );
+    }
+    pos++;
+    if( length < 0 || length > encoded_profile->length - pos )
+    {
+        error_handler( "Invalid length: Not enough bytes to decode feature", INVALID_VALUE_LENGTH );
+        return 0;
+    }
+    const jpro_tlv_rule* rule = get_tlv_rule( schema, view->tag );
+    view->feature = rule != 0 ? rule->feature : -1;
+    view->offset = pos;
+    view->length = length;
+    return pos + length;
+}
+
+/**
+ * @brief Find the signature length of a seal by walking the TLVs of the message zone up to the signature tag
+ * @param seal the seal
+ * @return the signature length | 0: error occurs
+*/
+static jpro_int32 find_signature_length( const jpro_data_view* seal )
+{
+    jpro_header_view header;
+    if( jpro_peek_header( seal->data, seal->length, &header ) == 0 )
+    {
+        return 0;
+    }
+    const jpro_profile_schema* schema = get_profile_schema( header.type );
+    jpro_int32 pos = header.header_length;
+    while( pos < seal->length )
+    {
+        if( seal->data[pos] == 0xff )                                           //the length of the signature is always DER-encoded
+        {
+            pos++;
+            if( pos >= seal->length ||
+                ( seal->data[pos] >= 128 && ( seal->data[pos] == 128 || seal->data[pos] > 132 || pos + seal->data[pos] - 128 >= seal->length ) ) )
+            {
+                error_handler( "Invalid length tag", INVALID_LENGTH_TAG );
+                return 0;
+            }
+            const jpro_int32 length = read_length_tag( seal, &pos );
+            if( length <= 0 )
+            {
+                error_handler( "Invalid signature length", INVALID_SIGNATURE_LENGTH );
+                return 0;
+            }
+            return length;                                                      //parse_seal_view checks that the signature ends the seal
+        }
+        jpro_feature_view view;
+        pos = read_tlv( seal, schema, pos, &view );                             //the same length rule as decoding the profile
+        if( pos == 0 )
+        {
+            return 0;                                                           //error handled in read_tlv
+        }
+    }
+    error_handler( "Signature tag not found", SIGNATURE_TAG_NOT_FOUND );
+    return 0;
+}
+
+/**
+ * @brief Parse a seal to views of its encoded profile and its signature without copying them
  * @param[in]  seal the seal to be parsed
- * @param[out] encoded_profile the encoded profile section of the seal
- * @param[out] signature the signature section of the seal
- * @param[in]  signature_length the length of the signature
+ * @param[in]  signature_length the length of the signature | JPRO_SIGNATURE_LENGTH_AUTO: read from the signature tag
+ * @param[out] encoded_profile the view of the encoded profile section in the seal
+ * @param[out] signature the view of the signature section in the seal
  * @return 1: success | 0: error occurs
 */
-jpro_int32 parse_seal(jpro_data* seal, jpro_data** encoded_profile, jpro_data** signature, jpro_int32 signature_length )
+jpro_boolean parse_seal_view(const jpro_data_view* seal, jpro_int32 signature_length, jpro_data_view* encoded_profile, jpro_data_view* signature)
 {
-    jpro_int32 length_tag_size;
+    if( signature_length == JPRO_SIGNATURE_LENGTH_AUTO )
+    {
+        signature_length = find_signature_length( seal );
+        if( signature_length == 0 )
+        {
+            return 0;                                                           //error handled in find_signature_length
+        }
+    }
 	if( signature_length <= 0 )
 	{
 		error_handler( "Invalid signature length", INVALID_SIGNATURE_LENGTH );
         return 0;
 	}
-	else if( signature_length <=127 )
-	{
-		length_tag_size = 1;
-	}
-	else
-	{
-		jpro_uint32 byte_cnt = 0;	//the number of the bytes used to encode the signature length
-		jpro_uint32 tmp = signature_length;
-		while( tmp != 0 )
-		{
-			tmp >>= 8;
-			byte_cnt++;
-		}
-		length_tag_size = byte_cnt + 1; //plus the initial byte of the length tag
-	}
+    const jpro_int32 length_tag_size = get_length_tag_size( signature_length );
 
 	jpro_int32 signature_tag_position = seal->length - signature_length - length_tag_size - 1;
-    if( seal->data[signature_tag_position] != 0xff )
+    if( signature_tag_position < 0 || seal->data[signature_tag_position] != 0xff )
     {
         error_handler( "Signature tag not found", SIGNATURE_TAG_NOT_FOUND );
         return 0;
@@ -266,203 +499,522 @@ jpro_int32 parse_seal(jpro_data* seal, jpro_data** encoded_profile, jpro_data**
         return 0;
     }
 
-    *encoded_profile = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * ( seal->length - signature_length - length_tag_size - 1 ) );
-    *signature = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * signature_length );
-    if( *encoded_profile == 0 || *signature == 0 )
+    encoded_profile->data = seal->data;
+    encoded_profile->length = signature_tag_position;
+    signature->data = seal->data + seal->length - signature_length;
+    signature->length = signature_length;
+	return 1;
+}
+
+/**
+ * @brief Parse a seal to an encoded profile and a signature
+ * @param[in]  seal the seal to be parsed
+ * @param[out] encoded_profile the encoded profile section of the seal
+ * @param[out] signature the signature section of the seal, raw r||s also for seals carrying a DER-encoded signature
+ * @param[in]  signature_length the length of the signature | JPRO_SIGNATURE_LENGTH_AUTO: read from the signature tag
+ * @return 1: success | 0: error occurs
+*/
+jpro_int32 parse_seal(jpro_data* seal, jpro_data** encoded_profile, jpro_data** signature, jpro_int32 signature_length )
+{
+    const jpro_data_view seal_view = { seal->data, seal->length };
+    jpro_data_view profile_view;
+    jpro_data_view signature_view;
+    const jpro_boolean parsed = parse_seal_view( &seal_view, signature_length, &profile_view, &signature_view );
+    if( parsed == 0 && signature_length == JPRO_SIGNATURE_LENGTH_AUTO )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
         return 0;
     }
-    (*encoded_profile)->length = seal->length - signature_length - length_tag_size - 1;
-    memcpy( (*encoded_profile)->data, seal->data, (*encoded_profile)->length );
 
-    (*signature)->length = signature_length;
-    memcpy( (*signature)->data, seal->data + (*encoded_profile)->length + 1 + length_tag_size, (*signature)->length );
+    //a DER-encoded signature has another length than the raw one, it is found by the signature tag
+    const jpro_byte* r;
+    const jpro_byte* s;
+    jpro_int32 r_length, s_length;
+    const jpro_boolean der = ( parsed == 0 || signature_length == JPRO_SIGNATURE_LENGTH_AUTO ) &&
+                             ( parsed || parse_seal_view( &seal_view, JPRO_SIGNATURE_LENGTH_AUTO, &profile_view, &signature_view ) ) &&
+                             read_der_signature( signature_view.data, signature_view.length, &r, &r_length, &s, &s_length );
+    if( parsed == 0 && der == 0 )
+    {
+        parse_seal_view( &seal_view, signature_length, &profile_view, &signature_view );     //report the error for the given signature length
+        return 0;
+    }
+    jpro_int32 raw_length = signature_view.length;
+    jpro_byte raw_signature[JPRO_MAX_RAW_SIGNATURE_SIZE];
+    if( der )
+    {
+        raw_length = signature_length != JPRO_SIGNATURE_LENGTH_AUTO ? signature_length :
+                     get_raw_signature_length( seal->data, seal->length, r_length > s_length ? r_length : s_length );
+        if( raw_length == 0 )
+        {
+            return 0;
+        }
+        if( raw_length > JPRO_MAX_RAW_SIGNATURE_SIZE )
+        {
+            error_handler( "Invalid signature length", INVALID_SIGNATURE_LENGTH );
+            return 0;
+        }
+        //convert before anything is allocated, so no out-parameter is left half-written on errors
+        if( jpro_signature_der_to_raw( signature_view.data, signature_view.length, raw_signature, raw_length ) == 0 )
+        {
+            return 0;       //error handled in jpro_signature_der_to_raw
+        }
+    }
+
+    jpro_data* profile_data = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * profile_view.length );
+    jpro_data* signature_data = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * raw_length );
+    if( profile_data == 0 || signature_data == 0 )
+    {
+        free( profile_data );
+        free( signature_data );
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    profile_data->length = profile_view.length;
+    memcpy( profile_data->data, profile_view.data, profile_view.length );
+    signature_data->length = raw_length;
+    memcpy( signature_data->data, der ? raw_signature : signature_view.data, raw_length );
 
+    *encoded_profile = profile_data;
+    *signature = signature_data;
 	return 1;
 }
 
 /**
- * @brief Decode an encoded profile
- * @param[in] encoded_profile the encoded profile to be decoded, it can also be a complete seal
- * @return the decoded profile | NULL: error occurs
+ * @brief Get the memory needed to decode a string value
+ * @param schema the schema of the profile
+ * @param rule the TLV rule of the value
+ * @param view the view of the value
+ * @return the number of characters including the terminating '\0'
 */
-jpro_profile_info* decode_profile(jpro_data* encoded_profile)
+static jpro_int32 get_string_value_size( const jpro_profile_schema* schema, const jpro_tlv_rule* rule, const jpro_feature_view* view )
 {
-    jpro_profile_type profile_type;
-	jpro_int32 header_length;
+    if( rule->codec == JPRO_CODEC_C40 )
+    {
+        jpro_int32 size = C40_DECODED_LENGTH( view->length );
+        if( rule->max_chars != 0 && size < schema->features[rule->feature].max_length )
+        {
+            size = schema->features[rule->feature].max_length;
+        }
+        return size + 1;
+    }
+    return view->length + 1;
+}
 
-    jpro_header_info* header = decode_profile_header( encoded_profile, &profile_type, &header_length );
-    if( header == 0 )
+/**
+ * @brief Decode a C40 or UTF-8 value
+ * @param[in] encoded_profile the encoded profile
+ * @param[in] schema the schema of the profile
+ * @param[in] rule the TLV rule of the value
+ * @param[in] view the view of the value
+ * @param[out] out the output buffer, at least get_string_value_size characters
+ * @return 1: success | 0: error occurs
+*/
+static jpro_boolean decode_string_value( const jpro_data_view* encoded_profile, const jpro_profile_schema* schema, const jpro_tlv_rule* rule, const jpro_feature_view* view, jpro_char* out )
+{
+    if( rule->codec == JPRO_CODEC_UTF8 )
+    {
+        memcpy( out, encoded_profile->data + view->offset, view->length );
+        out[view->length] = '\0';
+        return 1;
+    }
+    if( c40_decode_into( encoded_profile->data + view->offset, view->length, out ) == 0 )
     {
         return 0;
     }
+    if( rule->max_chars != 0 )                                              //e.g. visa type B: the MRZ is padded to its full length
+    {
+        const jpro_int32 max_length = schema->features[rule->feature].max_length;
+        jpro_int32 length = strlen( out );
+        if( length > rule->max_chars )
+        {
+            length = rule->max_chars;
+        }
+        for( ; length < max_length; length++ )
+        {
+            out[length] = '<';
+        }
+        out[max_length] = '\0';
+    }
+    return 1;
+}
 
-    if( profile_type == JPRO_VISA )
+/**
+ * @brief Decode the value of a TLV into the features of a profile
+ * @param[in] encoded_profile the encoded profile
+ * @param[in] schema the schema of the profile
+ * @param[in] rule the TLV rule of the value
+ * @param[in] view the view of the value
+ * @param[out] features the features of the decoded profile in schema order
+ * @param[in] arena the arena the values are allocated in | NULL: allocate on the heap
+ * @return 1: success | 0: error occurs
+*/
+static jpro_boolean decode_tlv_value( const jpro_data_view* encoded_profile, const jpro_profile_schema* schema, const jpro_tlv_rule* rule, const jpro_feature_view* view, jpro_feature_info* features, jpro_arena* arena )
+{
+    jpro_feature_info* feature = &features[rule->feature];
+    if( rule->codec == JPRO_CODEC_C40 || rule->codec == JPRO_CODEC_UTF8 )
     {
-        return ( get_decoded_profile_visa( encoded_profile, header, header_length ));
+        jpro_char* value = arena_alloc( arena, sizeof( jpro_char ) * get_string_value_size( schema, rule, view ) );
+        if( value == 0 )
+        {
+            error_handler( "Out of memory", OUT_OF_MEMORY );
+            return 0;
+        }
+        if( decode_string_value( encoded_profile, schema, rule, view, value ) == 0 )
+        {
+            arena_free( arena, value );
+            return 0;
+        }
+        feature->value_string = value;
     }
-    else if( profile_type == JPRO_RESIDENCE_PERMIT )
+    else if( rule->codec == JPRO_CODEC_INTEGER )
     {
-        return ( get_decoded_profile_rp( encoded_profile, header, header_length ));
+        if( view->length != rule->feature_cnt )
+        {
+            error_handler_detail( "Invalid value length of ", feature->name, INVALID_VALUE_LENGTH );
+            return 0;
+        }
+        for( jpro_int32 i = 0; i < rule->feature_cnt; i++ )
+        {
+            features[rule->feature + i].value_int = encoded_profile->data[view->offset + i];
+        }
     }
-    else if( profile_type == JPRO_SUPPLEMENTARY_SHEET )
+    else if( rule->codec == JPRO_CODEC_DATE )
     {
-        return ( get_decoded_profile_rp_supp_sheet( encoded_profile, header, header_length ));
+        if( view->length != 3 )
+        {
+            error_handler_detail( "Invalid value length of ", feature->name, INVALID_VALUE_LENGTH );
+            return 0;
+        }
+        feature->value_date = date_decode( encoded_profile->data + view->offset, arena );
+        if( strcmp( feature->value_date.day, "" ) == 0 )
+        {
+            return 0;       //error handled in date_decode
+        }
     }
-    else if( profile_type == JPRO_SOCIAL_INSURANCE_CARD )
+    return 1;
+}
+
+/**
+ * @brief Decode the message zone of an encoded profile in a single pass over its TLVs
+ * @param[in] encoded_profile the encoded profile
+ * @param[in] header_length the length of the encoded header
+ * @param[out] decoded_profile the profile created by get_profile_info_arena receiving the feature values
+ * @param[in] tags the tags of the features to be decoded, the values of all other features are skipped | NULL: decode all features
+ * @param[in] tag_cnt the number of tags
+ * @param[in] arena the arena the values are allocated in | NULL: allocate on the heap
+ * @return 1: success | 0: error occurs
+*/
+static jpro_boolean decode_message_zone( const jpro_data_view* encoded_profile, jpro_int32 header_length, jpro_profile_info* decoded_profile, const jpro_byte* tags, jpro_int32 tag_cnt, jpro_arena* arena )
+{
+    const jpro_profile_schema* schema = get_profile_schema( decoded_profile->type );
+    if( schema == 0 )
     {
-        return ( get_decoded_profile_sic( encoded_profile, header, header_length ));
+        return 0;
     }
-    else if( profile_type == JPRO_ARRIVAL_ATTESTATION_DOCUMENT )
+    jpro_boolean requested[256];
+    memset( requested, tags == 0, sizeof( requested ) );
+    for( jpro_int32 i = 0; tags != 0 && i < tag_cnt; i++ )
     {
-        return ( get_decoded_profile_aad( encoded_profile, header, header_length ));
+        requested[tags[i]] = 1;
     }
-    else if( profile_type == JPRO_ADDRESS_STICKER_FOR_ID_CARD )
+
+    jpro_int32 nr_required_features = 0;
+    for( jpro_int32 r = 0; r < schema->rule_cnt; r++ )
     {
-        return ( get_decoded_profile_addr_st_id( encoded_profile, header, header_length ));
+        if( requested[schema->rules[r].tag] && schema->rules[r].omit_if_prefix_of < 0 )
+        {
+            nr_required_features += schema->rules[r].feature_cnt;
+        }
     }
-    else if( profile_type == JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT )
+
+    jpro_int32 nr_found_features = 0;
+    jpro_int32 pos = header_length;
+    while( pos < encoded_profile->length && encoded_profile->data[pos] != 0xff )
     {
-        return ( get_decoded_profile_por( encoded_profile, header, header_length ));
+        jpro_feature_view view;
+        pos = read_tlv( encoded_profile, schema, pos, &view );
+        if( pos == 0 )
+        {
+            return 0;
+        }
+        const jpro_tlv_rule* rule = get_tlv_rule( schema, view.tag );
+        if( rule == 0 || requested[view.tag] == 0 )
+        {
+            continue;       //unknown or not requested feature, its value is skipped
+        }
+        if( decode_tlv_value( encoded_profile, schema, rule, &view, decoded_profile->features, arena ) == 0 )
+        {
+            return 0;
+        }
+        if( rule->omit_if_prefix_of < 0 )
+        {
+            nr_found_features += rule->feature_cnt;
+        }
     }
-    else
+
+    if( nr_found_features != nr_required_features )
     {
-        error_handler( "Unsupported profile type", UNSUPPORTED_PROFILE_TYPE );
+        error_handler( "Required feature not found", REQUIRED_FEATURE_NOT_FOUND );
         return 0;
     }
+    return 1;
 }
 
 /**
- *@brief decodes a encoded date
- *@param encoded_date the encoded date
- *@return the decoded date | ERROR: return an empty date
+ * @brief Decode an encoded profile into an arena
+ * @param[in] encoded_profile the encoded profile to be decoded, it can also be a complete seal
+ * @param[in] tags the tags of the features to be decoded | NULL: decode all features
+ * @param[in] tag_cnt the number of tags
+ * @param[in] arena the arena the decoded profile is allocated in | NULL: allocate on the heap
+ * @return the decoded profile | NULL: error occurs
 */
-jpro_date date_decode( jpro_byte* encoded_date )
+jpro_profile_info* decode_profile_arena(const jpro_data_view* encoded_profile, const jpro_byte* tags, jpro_int32 tag_cnt, jpro_arena* arena)
 {
-    jpro_date decoded_date;
-    jpro_date empty_date;
-    empty_date.day = "";
-    empty_date.month = "";
-    empty_date.year = "";
+    jpro_profile_type profile_type;
+	jpro_int32 header_length;
 
-	jpro_char date_str[9];
-	jpro_int32 date_int = (encoded_date[0] << 16) + (encoded_date[1] << 8) + encoded_date[2];
-	snprintf( date_str, 9, "%08d", date_int);	//mmddyyyy
+    jpro_header_info* header = decode_profile_header( encoded_profile, &profile_type, &header_length, arena );
+    if( header == 0 )
+    {
+        return 0;
+    }
 
-    decoded_date.month = malloc( sizeof( jpro_char ) * 3);
-    decoded_date.day = malloc( sizeof( jpro_char ) * 3);;
-    decoded_date.year = malloc( sizeof( jpro_char ) * 5);;
-    if( decoded_date.month == 0 || decoded_date.day == 0 || decoded_date.year == 0 )
+    jpro_profile_info* decoded_profile = get_profile_info_arena( profile_type, arena );
+    if( decoded_profile == 0 )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return empty_date;
+        return 0;
     }
+    decoded_profile->header = *header;
+    arena_free( arena, header );
 
-    snprintf( decoded_date.month, 3, "%c%c", date_str[0], date_str[1] );
-    snprintf( decoded_date.day, 3, "%c%c", date_str[2], date_str[3] );
-    snprintf( decoded_date.year, 5, "%s", date_str + 4 );
+    if( decode_message_zone( encoded_profile, header_length, decoded_profile, tags, tag_cnt, arena ) == 0 )
+    {
+        return 0;
+    }
+    return decoded_profile;
+}
 
-    return decoded_date;
+/**
+ * @brief Get the views of all TLVs in the message zone of an encoded profile without decoding their values
+ * @param[in] encoded_profile the encoded profile, it can also be a complete seal
+ * @param[out] type the profile type
+ * @param[out] views the views in the order of the message zone, they point into encoded_profile
+ * @param[in] max_views the number of views the output array can hold
+ * @return the number of TLVs in the message zone, only the first max_views are stored | 0: error occurs
+*/
+jpro_int32 get_feature_views(jpro_data* encoded_profile, jpro_profile_type* type, jpro_feature_view* views, jpro_int32 max_views)
+{
+    jpro_header_view header;
+    if( jpro_peek_header( encoded_profile->data, encoded_profile->length, &header ) == 0 )
+    {
+        return 0;
+    }
+    *type = header.type;
+    const jpro_profile_schema* schema = get_profile_schema( *type );
+    if( schema == 0 )
+    {
+        return 0;
+    }
+
+    const jpro_data_view encoded = { encoded_profile->data, encoded_profile->length };
+    jpro_int32 view_cnt = 0;
+    jpro_int32 pos = header.header_length;
+    while( pos < encoded_profile->length && encoded_profile->data[pos] != 0xff )
+    {
+        jpro_feature_view view;
+        pos = read_tlv( &encoded, schema, pos, &view );
+        if( pos == 0 )
+        {
+            return 0;
+        }
+        if( view_cnt < max_views )
+        {
+            views[view_cnt] = view;
+        }
+        view_cnt++;
+    }
+    if( view_cnt == 0 )
+    {
+        error_handler( "Feature tag not found", FEATURE_TAG_NOT_FOUND );
+        return 0;
+    }
+    return view_cnt;
 }
 
 /**
- *@brief decodes a single feature of an encoded profile
- *@param encoded_profile the encoded profile
- *@param pos the position at which the feature is in the raw data
- *@param feature_length_enc the length of the encoded feature
- *@param feature_length_dec the length of the decoded feature
- *@return the decoded feature | NULL: error occurs
+ * @brief Decode the string value of a feature view
+ * @param[in] encoded_profile the encoded profile the view points into
+ * @param[in] type the profile type
+ * @param[in] view the view of an alphanumeric, numeric or UTF-8 feature
+ * @param[out] out the output buffer, the decoded value is terminated with '\0'
+ * @param[in] capacity the size of the output buffer
+ * @return the length of the decoded value | 0: error occurs
 */
-jpro_char* decode_feature( jpro_data* encoded_profile, jpro_int32 pos, jpro_int32 feature_length_enc, jpro_int32 feature_length_dec )
+jpro_int32 decode_feature_view(jpro_data* encoded_profile, jpro_profile_type type, const jpro_feature_view* view, jpro_char* out, jpro_int32 capacity)
 {
-    if( encoded_profile->length < pos + feature_length_enc )
+    const jpro_profile_schema* schema = get_profile_schema( type );
+    if( schema == 0 )
+    {
+        return 0;
+    }
+    const jpro_tlv_rule* rule = get_tlv_rule( schema, view->tag );
+    if( rule == 0 || ( rule->codec != JPRO_CODEC_C40 && rule->codec != JPRO_CODEC_UTF8 ) )
+    {
+        error_handler( "Feature view is not a string", WRONG_INPUT );
+        return 0;
+    }
+    if( view->offset < 0 || view->length < 0 || view->length > encoded_profile->length - view->offset )
     {
         error_handler( "Invalid length: Not enough bytes to decode feature", INVALID_VALUE_LENGTH );
         return 0;
     }
-
-    jpro_data* feature_enc = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * ( feature_length_enc + 1 ));
-    if( feature_enc == 0 )
+    if( get_string_value_size( schema, rule, view ) > capacity )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
+        error_handler( "Output buffer too small", BUFFER_TOO_SMALL );
         return 0;
     }
-    feature_enc->length = feature_length_enc;
-    memcpy( feature_enc->data, encoded_profile->data + pos, feature_length_enc );
-    jpro_char* feature_dec = c40_decode( feature_enc );
-    if( feature_dec == 0 )
+    const jpro_data_view encoded = { encoded_profile->data, encoded_profile->length };
+    if( decode_string_value( &encoded, schema, rule, view, out ) == 0 )
     {
         return 0;
     }
+    return strlen( out );
+}
 
-    free( feature_enc );
+/**
+ * @brief Decode an encoded profile
+ * @param[in] encoded_profile the encoded profile to be decoded, it can also be a complete seal
+ * @return the decoded profile | NULL: error occurs
+*/
+jpro_profile_info* decode_profile(jpro_data* encoded_profile)
+{
+    const jpro_data_view view = { encoded_profile->data, encoded_profile->length };
+    return decode_profile_arena( &view, 0, 0, 0 );
+}
 
-    return feature_dec;
+/**
+ * @brief Decode an encoded profile that is not copied out of its buffer, e.g. from parse_seal_view
+ * @param[in] encoded_profile the view of the encoded profile, it can also be a complete seal
+ * @return the decoded profile | NULL: error occurs
+*/
+jpro_profile_info* decode_profile_view(const jpro_data_view* encoded_profile)
+{
+    return decode_profile_arena( encoded_profile, 0, 0, 0 );
 }
 
 /**
- *@brief decode a mrz of a profile
- *@param encoded_profile the encoded profile data that includes the mrz
- *@param pos the position at which the mrz starts
- *@param feature_length_enc the length of the encoded mrz
- *@param feature_length_dec the length of the decoded mrz
- *@return the decoded mrz | NULL: error occurs
+ * @brief Get an upper bound of the memory needed to decode an encoded profile into a single block
+ * @param encoded_length the length of the encoded profile
+ * @return the size of the block in bytes
 */
-jpro_char* decode_mrz( jpro_data* encoded_profile, jpro_int32 pos, jpro_int32 feature_length_enc, jpro_int32 feature_length_dec )
+size_t get_profile_block_size( jpro_int32 encoded_length )
 {
-    if( encoded_profile->length < pos + feature_length_enc )
-    {
-        error_handler( "Invalid length: Not enough bytes to decode mrz", INVALID_VALUE_LENGTH );
-        return 0;
-    }
+    //decoded C40 strings are 1.5 times as long as the encoded data, JPRO_PROFILE_BLOCK_RESERVE covers the dates, the
+    //terminating characters, the padded visa MRZ and the alignment of the allocations
+    return 2 * sizeof( jpro_profile_info ) + sizeof( jpro_header_info )
+           + JPRO_MAX_FEATURE_CNT * sizeof( jpro_feature_info )
+           + sizeof( jpro_crypto_info ) + 2 * sizeof( jpro_crypto_algo )
+           + 2 * (size_t) encoded_length + JPRO_PROFILE_BLOCK_RESERVE;
+}
 
-    jpro_data* mrz_encoded = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * (feature_length_enc + 1) );
-    if( mrz_encoded == 0 )
+/**
+ * @brief Decode the requested features of an encoded profile into a single memory block
+ * @param[in] encoded_profile the encoded profile to be decoded, it can also be a complete seal
+ * @param[in] tags the tags of the features to be decoded | NULL: decode all features
+ * @param[in] tag_cnt the number of tags
+ * @return the decoded profile | NULL: error occurs
+*/
+static jpro_profile_info* decode_profile_block_tags(const jpro_data_view* encoded_profile, const jpro_byte* tags, jpro_int32 tag_cnt)
+{
+    const size_t block_size = get_profile_block_size( encoded_profile->length );
+    jpro_arena arena = { malloc( block_size ), block_size, 0 };
+    if( arena.base == 0 )
     {
         error_handler( "Out of memory", OUT_OF_MEMORY );
         return 0;
     }
-    mrz_encoded->length = feature_length_enc;
-    memcpy( mrz_encoded->data, encoded_profile->data + pos, feature_length_enc );
-    jpro_char* mrz_decoded = c40_decode( mrz_encoded );
-    if( mrz_decoded == 0 )
+    jpro_profile_info* block_profile = arena_alloc( &arena, sizeof( jpro_profile_info ) );       //the profile_info is placed at the start of the block
+    jpro_profile_info* decoded_profile = decode_profile_arena( encoded_profile, tags, tag_cnt, &arena );
+    if( decoded_profile == 0 )
     {
+        free( arena.base );
         return 0;
     }
+    *block_profile = *decoded_profile;
+    return block_profile;
+}
 
-    free( mrz_encoded );
-
-    return mrz_decoded;
+/**
+ * @brief Decode an encoded profile into a single memory block
+ * @param[in] encoded_profile the encoded profile to be decoded, it can also be a complete seal
+ * @return the decoded profile, to be released with free_profile_block | NULL: error occurs
+*/
+jpro_profile_info* decode_profile_block(jpro_data* encoded_profile)
+{
+    const jpro_data_view view = { encoded_profile->data, encoded_profile->length };
+    return decode_profile_block_tags( &view, 0, 0 );
 }
 
 /**
- *@brief gets a utf-8 encoded string from raw data
- *@param encoded_profile the raw profile data
- *@param pos the position at which the utf-8 data starts
- *@param length the length of the string
- *@return the utf-8 string | NULL: error occurs
+ * @brief Decode only the requested features of an encoded profile, the values of all other features are skipped
+ * without being converted. The features that are not requested keep empty values.
+ * @param[in] seal the encoded profile to be decoded, it can also be a complete seal
+ * @param[in] tags the tags of the requested features, e.g. 0x05 for the passport number of a visa
+ * @param[in] tag_cnt the number of tags
+ * @return the decoded profile, to be released with free_profile_block | NULL: error occurs or a requested required feature is missing
 */
-jpro_char* get_utf8_string( jpro_data* encoded_profile, jpro_int32 pos, jpro_int32 length )
+jpro_profile_info* decode_profile_fields(jpro_data* seal, const jpro_byte* tags, jpro_int32 tag_cnt)
 {
-    if( encoded_profile->length < pos + length )                    //check if remaining bytes in encoded profile are sufficient to read string of length 'length'
+    if( tags == 0 || tag_cnt <= 0 )
     {
-        error_handler( "Invalid length: Not enough bytes to read utf8-string", INVALID_VALUE_LENGTH );
+        error_handler( "Wrong input: no feature tags requested", WRONG_INPUT );
         return 0;
     }
+    const jpro_data_view view = { seal->data, seal->length };
+    return decode_profile_block_tags( &view, tags, tag_cnt );
+}
 
-    jpro_char* utf8_str = malloc( sizeof( jpro_char ) * ( length + 1 ));
-    if( utf8_str == 0 )
+/**
+ *@brief decodes a encoded date
+ *@param encoded_date the encoded date
+ *@param arena the arena the decoded date is allocated in | NULL: allocate on the heap
+ *@return the decoded date | ERROR: return an empty date
+*/
+jpro_date date_decode( const jpro_byte* encoded_date, jpro_arena* arena )
+{
+    jpro_date decoded_date;
+    jpro_date empty_date;
+    empty_date.day = "";
+    empty_date.month = "";
+    empty_date.year = "";
+
+    const jpro_uint32 date = jpro_date_decode( encoded_date );
+    if( arena != 0 )                                                        //the strings are released with the arena, share one buffer
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return 0;
+        jpro_char* buffer = arena_alloc( arena, sizeof( jpro_char ) * JPRO_DATE_STRING_SIZE );
+        if( buffer == 0 )
+        {
+            error_handler( "Out of memory", OUT_OF_MEMORY );
+            return empty_date;
+        }
+        return jpro_date_unpack( date, buffer );
     }
-    for( jpro_int32 position = 0; position < length; position++ )
+
+    decoded_date.month = malloc( sizeof( jpro_char ) * 3);                 //freed one by one in free_header_info_data
+    decoded_date.day = malloc( sizeof( jpro_char ) * 3);
+    decoded_date.year = malloc( sizeof( jpro_char ) * 5);
+    if( decoded_date.month == 0 || decoded_date.day == 0 || decoded_date.year == 0 )
     {
-        sprintf( utf8_str + position, "%c", encoded_profile->data[pos + position] );
+        free( decoded_date.month );
+        free( decoded_date.day );
+        free( decoded_date.year );
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return empty_date;
     }
+    write_digits( date / 10000, 4, decoded_date.year );
+    write_digits( ( date / 100 ) % 100, 2, decoded_date.month );
+    write_digits( date % 100, 2, decoded_date.day );
 
-    return utf8_str;
+    return decoded_date;
 }
 
 /**
@@ -471,7 +1023,7 @@ jpro_char* get_utf8_string( jpro_data* encoded_profile, jpro_int32 pos, jpro_int
  *@param[out] pos the position to start reading, returning the position where reading stopped
  *@return the length value that was stored in a length tag | 0: ERROR occurs
 */
-jpro_int32 read_length_tag( jpro_data* encoded_profile, jpro_int32* pos )
+jpro_int32 read_length_tag( const jpro_data_view* encoded_profile, jpro_int32* pos )
 {
     if( encoded_profile->data[*pos] < 128 )
     {
@@ -488,7 +1040,7 @@ jpro_int32 read_length_tag( jpro_data* encoded_profile, jpro_int32* pos )
         jpro_int32 feature_length = 0;
         for( jpro_int32 loop = (*pos + tag_length); loop > *pos; loop-- )
         {
-            jpro_int32 val = encoded_profile->data[loop];
+            jpro_uint32 val = encoded_profile->data[loop];
 			feature_length += val << ((tag_length - (loop - *pos)) * 8 );
         }
         *pos = *pos + tag_length;
@@ -515,6 +1067,15 @@ void free_dec_header( jpro_header_info* decoded_header )
     free( decoded_header );
 }
 
+/**
+ *@brief free a profile decoded by decode_profile_block together with all its data
+ *@param profile_info the profile to be freed
+*/
+void free_profile_block( jpro_profile_info* profile_info )
+{
+    free( profile_info );
+}
+
 /**
  *@brief free allocated string values of features
  *@param profile_info the profile containing the features
@@ -13,59 +13,97 @@
 #include "jabpro.h"
 #include "encoder.h"
 #include "c40.h"
+#include "utf8.h"
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
+#include <stdint.h>
+
+static _Thread_local jpro_error_state jpro_error = { 0, "", "", "" };
+
+/**
+ * @brief Names of the supported profiles
+*/
+static jpro_char* jpro_profile_names[JPRO_PROFILE_CNT] = { "Visa",
+                                                             "Arrival attestation document",
+                                                             "Social incurance card",
+                                                             "Residence permit",
+                                                             "Residence permit supplementary sheet",
+                                                             "Address sticker for ID card",
+                                                             "Place of residence sticker for Passport"
+                                                           };
+
+/**
+ * @brief Types of the supported profiles
+*/
+static jpro_profile_type jpro_profile_types[JPRO_PROFILE_CNT] = { JPRO_VISA,
+                                                                    JPRO_ARRIVAL_ATTESTATION_DOCUMENT,
+                                                                    JPRO_SOCIAL_INSURANCE_CARD,
+                                                                    JPRO_RESIDENCE_PERMIT,
+                                                                    JPRO_SUPPLEMENTARY_SHEET,
+                                                                    JPRO_ADDRESS_STICKER_FOR_ID_CARD,
+                                                                    JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT
+                                                                  };
+
+static jpro_profile_list jpro_supported_profiles = { JPRO_ARRAY_SIZE( jpro_profile_types ), jpro_profile_names, jpro_profile_types };
 
 /**
- * @brief Global error code
+ * @brief Schemas of the supported profiles indexed by the profile type
 */
-jpro_error_code global_error_code;
-jpro_char jpro_error_msg[256];
+static const jpro_profile_schema* const jpro_profile_schemas[JPRO_PROFILE_CNT] = { [JPRO_VISA] = &jpro_schema_visa,
+                                                                                     [JPRO_ARRIVAL_ATTESTATION_DOCUMENT] = &jpro_schema_aad,
+                                                                                     [JPRO_SOCIAL_INSURANCE_CARD] = &jpro_schema_sic,
+                                                                                     [JPRO_RESIDENCE_PERMIT] = &jpro_schema_rp,
+                                                                                     [JPRO_SUPPLEMENTARY_SHEET] = &jpro_schema_rp_supp_sheet,
+                                                                                     [JPRO_ADDRESS_STICKER_FOR_ID_CARD] = &jpro_schema_addr_st_id,
+                                                                                     [JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT] = &jpro_schema_por
+                                                                                   };
 
 /**
  * @brief Output a list of supported profiles
- * @return the profile list | NULL: error occurs
+ * @return the profile list, it is static and must not be modified
 */
 jpro_profile_list* get_supported_profiles()
 {
-    jpro_profile_list *supported_profiles = malloc( sizeof( jpro_profile_list ) );
-    if( supported_profiles == NULL )
-    {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return 0;
-    }
-    supported_profiles->profile_cnt = 7;
-    supported_profiles->profile_names = malloc( sizeof( char* ) * supported_profiles->profile_cnt );
-    if( supported_profiles->profile_names == NULL )
+	return &jpro_supported_profiles;
+}
+
+/**
+ * @brief Get the schema of a profile
+ * @param[in] profile_type the profile type
+ * @return the schema | NULL: unsupported profile type
+*/
+const jpro_profile_schema* get_profile_schema(jpro_profile_type profile_type)
+{
+    if( (jpro_uint32) profile_type >= JPRO_ARRAY_SIZE( jpro_profile_schemas ) )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
+        error_handler( "Profile type not supported", UNSUPPORTED_PROFILE_TYPE );
         return 0;
     }
-    supported_profiles->profile_names[0] = "Visa";
-    supported_profiles->profile_names[1] = "Arrival attestation document";
-    supported_profiles->profile_names[2] = "Social incurance card";
-    supported_profiles->profile_names[3] = "Residence permit";
-    supported_profiles->profile_names[4] = "Residence permit supplementary sheet";
-    supported_profiles->profile_names[5] = "Address sticker for ID card";
-    supported_profiles->profile_names[6] = "Place of residence sticker for Passport";
+    return jpro_profile_schemas[profile_type];
+}
 
-    supported_profiles->profile_types = malloc( sizeof( jpro_profile_type) * supported_profiles->profile_cnt );
-    if( supported_profiles->profile_types == NULL )
+/**
+ * @brief Get the schema of a profile by the identifiers in the seal header
+ * @param[in] version the header version
+ * @param[in] feature_ref the document feature definition reference
+ * @param[in] document_type the document type category
+ * @return the schema | NULL: unknown profile type
+*/
+const jpro_profile_schema* get_profile_schema_by_id(jpro_byte version, jpro_byte feature_ref, jpro_byte document_type)
+{
+    for( jpro_uint32 i = 0; i < JPRO_ARRAY_SIZE( jpro_profile_schemas ); i++ )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return 0;
+        if( jpro_profile_schemas[i]->version == version &&
+            jpro_profile_schemas[i]->feature_ref == feature_ref &&
+            jpro_profile_schemas[i]->document_type == document_type )
+        {
+            return jpro_profile_schemas[i];
+        }
     }
-    supported_profiles->profile_types[0] = JPRO_VISA;
-    supported_profiles->profile_types[1] = JPRO_ARRIVAL_ATTESTATION_DOCUMENT;
-    supported_profiles->profile_types[2] = JPRO_SOCIAL_INSURANCE_CARD;
-    supported_profiles->profile_types[3] = JPRO_RESIDENCE_PERMIT;
-    supported_profiles->profile_types[4] = JPRO_SUPPLEMENTARY_SHEET;
-    supported_profiles->profile_types[5] = JPRO_ADDRESS_STICKER_FOR_ID_CARD;
-    supported_profiles->profile_types[6] = JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT;
-	return supported_profiles;
+    error_handler( "Unknown profile type in header", UNKNOWN_PROFILE_TYPE );
+    return 0;
 }
 
 /**
@@ -75,143 +113,678 @@ jpro_profile_list* get_supported_profiles()
 */
 jpro_profile_info* get_profile_info(jpro_profile_type profile_type)
 {
-    if ( profile_type == JPRO_SOCIAL_INSURANCE_CARD )
+    return get_profile_info_arena( profile_type, 0 );
+}
+
+/**
+ * @brief Output the information of a profile allocated in an arena
+ * @param[in] profile_type the profile type whose information shall be output
+ * @param[in] arena the arena the profile information is allocated in | NULL: allocate on the heap
+ * @return the profile information | NULL: unsupported profile type
+*/
+jpro_profile_info* get_profile_info_arena(jpro_profile_type profile_type, jpro_arena* arena)
+{
+    const jpro_profile_schema* schema = get_profile_schema( profile_type );
+    if( schema == 0 )
     {
-        return get_sic_info();
+        return 0;
     }
-    else if ( profile_type == JPRO_VISA )
+    jpro_feature_info* features = arena_alloc( arena, sizeof( jpro_feature_info ) * schema->feature_cnt );
+    if( features == 0 )
     {
-        return get_visa_info();
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
     }
-    else if ( profile_type == JPRO_ARRIVAL_ATTESTATION_DOCUMENT )
+    memcpy( features, schema->features, sizeof( jpro_feature_info ) * schema->feature_cnt );
+
+    jpro_profile_info* profile_info = create_profile_info( schema->type, schema->feature_cnt, features, (jpro_crypto_info*) schema->crypto, arena );
+    if( profile_info == 0 )
     {
-        return get_aad_info();
+        arena_free( arena, features );
     }
-    else if ( profile_type == JPRO_RESIDENCE_PERMIT )
+    return profile_info;
+}
+
+/**
+ * @brief Check that the features of a profile match the profile definition
+ * @param[in] profile_info the profile information to be checked
+ * @return 1: success | 0: error occurs
+*/
+static jpro_boolean check_profile_features(jpro_profile_info* profile_info)
+{
+    const jpro_profile_schema* schema = get_profile_schema( profile_info->type );
+    if( schema == 0 )
     {
-        return get_rp_info();
+        return 0;
     }
-    else if ( profile_type == JPRO_SUPPLEMENTARY_SHEET )
+
+    //profiles created by get_profile_info have the features in the order of the schema
+    jpro_boolean in_schema_order = profile_info->feature_cnt == schema->feature_cnt;
+    for( jpro_int32 i = 0; in_schema_order && i < schema->feature_cnt; i++ )
     {
-        return get_rp_supp_sheet_info();
+        in_schema_order = profile_info->features[i].name == schema->features[i].name ||
+                          strcmp( profile_info->features[i].name, schema->features[i].name ) == 0;
     }
-    else if ( profile_type == JPRO_ADDRESS_STICKER_FOR_ID_CARD )
+
+    jpro_int32 matching_features = 0;
+    for( jpro_int32 cmp = 0; cmp < schema->feature_cnt; cmp++ )
     {
-        return get_addr_st_id_info();
+        const jpro_int32 first = in_schema_order ? cmp : 0;
+        const jpro_int32 last = in_schema_order ? cmp + 1 : profile_info->feature_cnt;
+        for( jpro_int32 loop = first; loop < last; loop++ )
+        {
+            if( !in_schema_order && strcmp( schema->features[cmp].name, profile_info->features[loop].name ) != 0 )
+            {
+                continue;
+            }
+            if( schema->features[cmp].value_type != profile_info->features[loop].value_type ||
+                schema->features[cmp].min_length != profile_info->features[loop].min_length ||
+                schema->features[cmp].max_length != profile_info->features[loop].max_length )
+            {
+                error_handler( "Feature data does not match profile", FEATURE_DATA_DOES_NOT_MATCH_PROFILE );
+                return 0;
+            }
+            matching_features+=1;
+        }
     }
-    else if ( profile_type == JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT )
+    if( matching_features != schema->feature_cnt )
     {
-        return get_por_info();
+        error_handler( "Invalid amount of mandatory features", INVALID_FEATURE_COUNT );
+        return 0;
     }
-    else
+    return 1;
+}
+
+/**
+ *@brief Character classes of feature values
+*/
+#define JPRO_CLASS_NUMERIC      0x01
+#define JPRO_CLASS_ALPHANUMERIC 0x02
+
+static const jpro_byte value_class_table[256] = {                          //digits are of both classes
+    ['0'] = 3, ['1'] = 3, ['2'] = 3, ['3'] = 3, ['4'] = 3, ['5'] = 3, ['6'] = 3, ['7'] = 3, ['8'] = 3, ['9'] = 3,
+    ['A'] = 2, ['B'] = 2, ['C'] = 2, ['D'] = 2, ['E'] = 2, ['F'] = 2, ['G'] = 2, ['H'] = 2, ['I'] = 2, ['J'] = 2,
+    ['K'] = 2, ['L'] = 2, ['M'] = 2, ['N'] = 2, ['O'] = 2, ['P'] = 2, ['Q'] = 2, ['R'] = 2, ['S'] = 2, ['T'] = 2,
+    ['U'] = 2, ['V'] = 2, ['W'] = 2, ['X'] = 2, ['Y'] = 2, ['Z'] = 2, ['<'] = 2
+};
+
+/**
+ *@brief Check that all characters of a string are of a class
+ *@param s the input string
+ *@param length the length of the string
+ *@param value_class JPRO_CLASS_NUMERIC or JPRO_CLASS_ALPHANUMERIC
+ *@return 1: all characters are of the class | 0: a character is not of the class
+*/
+static jpro_boolean check_class( const jpro_char* s, jpro_int32 length, jpro_byte value_class )
+{
+    const jpro_byte* bytes = (const jpro_byte*) s;
+    jpro_byte valid = value_class;
+    for( jpro_int32 i = 0; i < length; i++ )
     {
-        error_handler( "Profile type not supported", UNSUPPORTED_PROFILE_TYPE );
-        return 0;
+        valid &= value_class_table[bytes[i]];
     }
+    return valid != 0;
 }
 
 /**
- * @brief Encode a profile
- * @param[in] profile_info the profile information to be encoded
- * @return the encoded profile | NULL: error occurs
+ *@brief Check that a string is valid UTF-8 (RFC 3629) with the vectorized validator
+ *@param s the input string
+ *@param length the length of the string in bytes
+ *@return 1: valid UTF-8 | 0: invalid UTF-8
 */
-jpro_data* encode_profile(jpro_profile_info* profile_info)
+static jpro_boolean check_utf_8( const jpro_char* s, jpro_int32 length )
 {
-    jpro_profile_info* compare_profile = get_profile_info( profile_info->type );
-    jpro_int32 matching_features = 0;
-    for( jpro_int32 cmp = 0; cmp < compare_profile->feature_cnt; cmp++ )
+    return utf8_kernels.validate( (const jpro_byte*) s, length );
+}
+
+/**
+ *@brief Check that a string view can be read
+ *@param view the string view
+ *@return 1: the view is readable | 0: negative length or no data
+*/
+static jpro_boolean is_readable( const jpro_string_view* view )
+{
+    return view->length >= 0 && ( view->data != 0 || view->length == 0 );
+}
+
+/**
+ *@brief Get the view of a string terminated with '\0'
+ *@param s the string | NULL: no value
+ *@return the view of the string
+*/
+static jpro_string_view get_string_view( const jpro_char* s )
+{
+    jpro_string_view view = { s, s ? (jpro_int32) strlen( s ) : 0 };
+    return view;
+}
+
+/**
+ *@brief Check the length and the value type of every feature
+ *@param schema the schema of the profile
+ *@param values the feature values in schema order
+ *@return 1: success | 0: error occurs
+*/
+static jpro_boolean check_feature_values( const jpro_profile_schema* schema, const jpro_feature_value* values )
+{
+    for ( jpro_int32 i = 0; i < schema->feature_cnt; i++ )
     {
-        for( jpro_int32 loop = 0; loop < profile_info->feature_cnt; loop++ )
+        const jpro_feature_info* feature = &schema->features[i];
+        const jpro_feature_value* value = &values[i];
+        if( feature->value_type == JPRO_INTEGER )
         {
-            if( strcmp( compare_profile->features[cmp].name, profile_info->features[loop].name ) == 0 &&
-                      ( compare_profile->features[cmp].value_type != profile_info->features[loop].value_type ||
-                        compare_profile->features[cmp].min_length != profile_info->features[loop].min_length ||
-                        compare_profile->features[cmp].max_length != profile_info->features[loop].max_length ))
+            const jpro_int64 max_value = feature->max_length >= 4 ? INT32_MAX : ( (jpro_int64) 1 << ( feature->max_length * 8 ) ) - 1;
+            const jpro_int64 min_value = feature->min_length > 1 ? (jpro_int64) 1 << ( ( feature->min_length - 1 ) * 8 ) : 0;
+            if( value->value_int > max_value || value->value_int < min_value )
             {
-                error_handler( "Feature data does not match profile", FEATURE_DATA_DOES_NOT_MATCH_PROFILE );
+                error_handler_detail( "Invalid value length of ", feature->name, INVALID_VALUE_LENGTH );
                 return 0;
             }
-            if( strcmp( compare_profile->features[cmp].name, profile_info->features[loop].name ) == 0 )
+            continue;
+        }
+        else if( feature->value_type == JPRO_DATE )
+        {
+            if ( jpro_date_is_valid( value->value_date ) == 0 )
             {
-                matching_features+=1;
+                error_handler_detail( "Invalid date of ", feature->name, INVALID_DATE );
+                return 0;
             }
+            continue;
+        }
+
+        const jpro_string_view* string = &value->value_string;
+        if( is_readable( string ) == 0 )
+        {
+            error_handler_detail( "Invalid value length of ", feature->name, INVALID_VALUE_LENGTH );
+            return 0;
+        }
+        jpro_boolean valid = 1;
+        if( feature->value_type == JPRO_ALPHANUMERIC )
+        {
+            valid = check_class( string->data, string->length, JPRO_CLASS_ALPHANUMERIC );
+        }
+        else if( feature->value_type == JPRO_NUMERIC )
+        {
+            valid = check_class( string->data, string->length, JPRO_CLASS_NUMERIC );
+        }
+        else if( feature->value_type == JPRO_BINARY_UTF8 )
+        {
+            valid = check_utf_8( string->data, string->length );
+        }
+        if( valid == 0 )
+        {
+            error_handler_detail( "Invalid value type of ", feature->name, INVALID_VALUE_TYPE );
+            return 0;
+        }
+        if( string->length < feature->min_length || string->length > feature->max_length )
+        {
+            error_handler_detail( "Invalid value length of ", feature->name, INVALID_VALUE_LENGTH );
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Get the values of a profile as string views and packed dates, computing the length of every string once
+ * @param[in] profile_info the profile information
+ * @param[in] schema the schema of the profile
+ * @param[out] header the header values
+ * @param[out] values the feature values in schema order
+ * @return 1: success | 0: error occurs
+*/
+static jpro_boolean get_profile_values( jpro_profile_info* profile_info, const jpro_profile_schema* schema, jpro_header_values* header, jpro_feature_value* values )
+{
+    header->issuing_country = get_string_view( profile_info->header.issuing_country );
+    header->signer_country = get_string_view( profile_info->header.signer_country );
+    header->signer_id = get_string_view( profile_info->header.signer_id );
+    header->certificate_ref = get_string_view( profile_info->header.certificate_ref );
+    header->issue_date = jpro_date_pack( profile_info->header.issue_date );
+    header->signature_date = jpro_date_pack( profile_info->header.signature_date );
+
+    for( jpro_int32 i = 0; i < schema->feature_cnt; i++ )
+    {
+        const jpro_feature_info* feature = find_schema_feature( profile_info, schema, i );
+        if( feature == 0 )
+        {
+            error_handler( "Required feature not found", REQUIRED_FEATURE_NOT_FOUND );
+            return 0;
+        }
+        const jpro_string_view no_string = { 0, 0 };
+        values[i].value_string = no_string;
+        values[i].value_date = 0;
+        values[i].value_int = feature->value_int;
+        if( feature->value_type == JPRO_DATE )
+        {
+            values[i].value_date = jpro_date_pack( feature->value_date );
+        }
+        else if( feature->value_type != JPRO_INTEGER )
+        {
+            values[i].value_string = get_string_view( feature->value_string );
         }
     }
-    if( matching_features != compare_profile->feature_cnt )
+    return 1;
+}
+
+/**
+ * @brief Check the feature data of a profile before encoding
+ * @param[in] profile_info the profile information to be checked
+ * @param[out] header the header values of the profile
+ * @param[out] values the feature values of the profile in schema order
+ * @return the schema of the profile | NULL: error occurs
+*/
+static const jpro_profile_schema* check_profile(jpro_profile_info* profile_info, jpro_header_values* header, jpro_feature_value* values)
+{
+    if ( check_profile_features( profile_info ) == 0 )          //check features against the profile definition
+    {
+        return 0;
+    }
+
+    const jpro_profile_schema* schema = get_profile_schema( profile_info->type );
+    if( get_profile_values( profile_info, schema, header, values ) == 0 )
+    {
+        return 0;
+    }
+    if ( check_feature_values( schema, values ) == 0 )         //check feature length and value type
+    {
+        return 0;
+    }
+    return schema;
+}
+
+/**
+ * @brief Encode checked feature values into a buffer
+ * @param[in] schema the schema of the profile
+ * @param[in] header the header values
+ * @param[in] values the checked feature values in schema order
+ * @param[out] out the output buffer
+ * @param[in] capacity the size of the output buffer
+ * @return the length of the encoded profile | 0: error occurs
+*/
+static jpro_int32 encode_checked_values(const jpro_profile_schema* schema, const jpro_header_values* header, const jpro_feature_value* values, jpro_byte* out, jpro_int32 capacity)
+{
+    const jpro_int32 header_length = encode_header_into( schema, header, out, capacity );
+    if( header_length == 0 )
+    {
+        return 0;
+    }
+    const jpro_int32 message_zone_length = encode_message_zone( schema, values, out + header_length, capacity - header_length );
+    if( message_zone_length == 0 )
+    {
+        return 0;
+    }
+    return header_length + message_zone_length;
+}
+
+/**
+ * @brief Encode checked feature values into a caller-provided buffer
+ * @param[in] schema the schema of the profile
+ * @param[in] header the header values
+ * @param[in] values the checked feature values in schema order
+ * @param[out] out the output buffer
+ * @param[in] capacity the size of the output buffer
+ * @param[out] written the length of the encoded profile
+ * @return 1: success | 0: error occurs
+*/
+static jpro_boolean encode_checked_values_into(const jpro_profile_schema* schema, const jpro_header_values* header, const jpro_feature_value* values, jpro_byte* out, size_t capacity, size_t* written)
+{
+    const jpro_int32 length = encode_checked_values( schema, header, values, out, capacity > INT32_MAX ? INT32_MAX : (jpro_int32) capacity );
+    if( length == 0 )
+    {
+        return 0;
+    }
+    if( written )
+    {
+        *written = length;
+    }
+    return 1;
+}
+
+/**
+ * @brief Encode a profile into a caller-provided buffer without allocating memory for the encoded data
+ * @param[in] profile_info the profile information to be encoded
+ * @param[out] out the output buffer
+ * @param[in] capacity the size of the output buffer
+ * @param[out] written the length of the encoded profile
+ * @return 1: success | 0: error occurs (BUFFER_TOO_SMALL if the encoded profile does not fit into the buffer)
+*/
+jpro_boolean encode_profile_into(jpro_profile_info* profile_info, jpro_byte* out, size_t capacity, size_t* written)
+{
+    jpro_header_values header;
+    jpro_feature_value values[JPRO_MAX_FEATURE_CNT];
+    const jpro_profile_schema* schema = check_profile( profile_info, &header, values );
+    if( schema == 0 )
+    {
+        return 0;
+    }
+    return encode_checked_values_into( schema, &header, values, out, capacity, written );
+}
+
+/**
+ * @brief Encode a profile given as string views into a caller-provided buffer, the strings need not be terminated with '\0'
+ * @param[in] type the profile type
+ * @param[in] header the header values
+ * @param[in] values the feature values in the order of the features of get_profile_info
+ * @param[in] value_cnt the number of feature values
+ * @param[out] out the output buffer
+ * @param[in] capacity the size of the output buffer
+ * @param[out] written the length of the encoded profile
+ * @return 1: success | 0: error occurs (BUFFER_TOO_SMALL if the encoded profile does not fit into the buffer)
+*/
+jpro_boolean encode_profile_values_into(jpro_profile_type type, const jpro_header_values* header, const jpro_feature_value* values, jpro_int32 value_cnt, jpro_byte* out, size_t capacity, size_t* written)
+{
+    const jpro_profile_schema* schema = get_profile_schema( type );
+    if( schema == 0 )
+    {
+        return 0;
+    }
+    if( value_cnt != schema->feature_cnt )
     {
         error_handler( "Invalid amount of mandatory features", INVALID_FEATURE_COUNT );
         return 0;
     }
+    if( check_feature_values( schema, values ) == 0 )
+    {
+        return 0;
+    }
+    return encode_checked_values_into( schema, header, values, out, capacity, written );
+}
 
-    free_profile_info( compare_profile );
+/**
+ * @brief Encode a profile
+ * @param[in] profile_info the profile information to be encoded
+ * @return the encoded profile | NULL: error occurs
+*/
+jpro_data* encode_profile(jpro_profile_info* profile_info)
+{
+    jpro_header_values header;
+    jpro_feature_value values[JPRO_MAX_FEATURE_CNT];
+    const jpro_profile_schema* schema = check_profile( profile_info, &header, values );
+    if( schema == 0 )
+    {
+        return 0;
+    }
 
-    if ( check_length( profile_info ) == 0 )	                  //check feature length
+    const jpro_int32 length = get_encoded_profile_size( schema, &header, values );         //allocate the exact size
+    if( length == 0 )
     {
-        return NULL;
+        return 0;
+    }
+    jpro_data* encoded_profile = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * length );
+    if( encoded_profile == NULL )
+    {
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
     }
+    encoded_profile->length = encode_checked_values( schema, &header, values, encoded_profile->data, length );
+    if( encoded_profile->length == 0 )
+    {
+        free( encoded_profile );
+        return 0;
+    }
+    return encoded_profile;
+}
 
-    if ( check_value_type( profile_info ) == 0 )                //check feature value_type
+/**
+ * @brief Get the length of an encoded profile without encoding it
+ * @param[in] schema the schema of the profile
+ * @param[in] header the header values
+ * @param[in] values the feature values in schema order
+ * @return the length of the encoded profile | 0: error occurs
+*/
+jpro_int32 get_encoded_profile_size(const jpro_profile_schema* schema, const jpro_header_values* header, const jpro_feature_value* values)
+{
+    const jpro_int32 header_length = get_header_size( schema, header );
+    if( header_length == 0 )
     {
-        return NULL;
+        return 0;
+    }
+    const jpro_int32 message_zone_length = encode_message_zone( schema, values, 0, 0 );
+    if( message_zone_length == 0 )
+    {
+        return 0;
     }
+    return header_length + message_zone_length;
+}
 
-    if ( profile_info->type == JPRO_SOCIAL_INSURANCE_CARD )
+/**
+ * @brief Get the exact length of the seal of a profile without encoding it
+ * @param[in] profile_info the profile information to be encoded
+ * @param[in] signature_algo the signature algorithm | NULL: the first signature algorithm of the profile
+ * @return the length of the encoded profile including signature tag, length tag and signature | 0: error occurs
+*/
+size_t jpro_encoded_size(jpro_profile_info* profile_info, jpro_crypto_algo* signature_algo)
+{
+    if( signature_algo == 0 )
     {
-        return get_encoded_sic( profile_info );
+        if( profile_info->crypto == 0 || profile_info->crypto->signature_algo_cnt < 1 )
+        {
+            error_handler( "Signature algorithm not found", WRONG_INPUT );
+            return 0;
+        }
+        signature_algo = &profile_info->crypto->signature_algos[0];
     }
-    else if ( profile_info->type == JPRO_VISA )
+    const jpro_profile_schema* schema = get_profile_schema( profile_info->type );
+    jpro_header_values header;
+    jpro_feature_value values[JPRO_MAX_FEATURE_CNT];
+    if( schema == 0 || get_profile_values( profile_info, schema, &header, values ) == 0 )
     {
-        return get_encoded_visa( profile_info );
+        return 0;
     }
-    else if ( profile_info->type == JPRO_ARRIVAL_ATTESTATION_DOCUMENT )
+    const jpro_int32 profile_length = get_encoded_profile_size( schema, &header, values );
+    if( profile_length == 0 )
     {
-        return get_encoded_aad( profile_info );
+        return 0;
     }
-    else if ( profile_info->type == JPRO_RESIDENCE_PERMIT )
+    const jpro_int32 signature_length = ( signature_algo->size + 7 ) / 8;          //the size is given in bits
+    return (size_t) profile_length + 1 + get_length_tag_size( signature_length ) + signature_length;
+}
+
+/**
+ * @brief Read r and s of a DER-encoded ECDSA signature (SEQUENCE of two INTEGERs) without raising errors
+ * @param der the DER-encoded signature
+ * @param der_length the length of the DER-encoded signature
+ * @param[out] r the big-endian value of r without leading zeros
+ * @param[out] r_length the length of r
+ * @param[out] s the big-endian value of s without leading zeros
+ * @param[out] s_length the length of s
+ * @return 1: the data is a DER-encoded signature | 0: it is not
+*/
+jpro_boolean read_der_signature( const jpro_byte* der, size_t der_length, const jpro_byte** r, jpro_int32* r_length, const jpro_byte** s, jpro_int32* s_length )
+{
+    if( der_length < 8 || der[0] != 0x30 )
     {
-        return get_encoded_rp( profile_info );
+        return 0;
     }
-    else if ( profile_info->type == JPRO_SUPPLEMENTARY_SHEET )
+    size_t pos = 2;
+    size_t sequence_length = der[1];
+    if( sequence_length == 0x81 )                                           //long form for curves above 480 bits
     {
-        return get_encoded_rp_supp_sheet( profile_info );
+        sequence_length = der[pos++];
     }
-    else if ( profile_info->type == JPRO_ADDRESS_STICKER_FOR_ID_CARD )
+    else if( sequence_length > 127 )
     {
-        return get_encoded_addr_st_id( profile_info );
+        return 0;
     }
-    else if( profile_info->type == JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT )
+    if( pos + sequence_length != der_length )
     {
-        return get_encoded_por( profile_info );
+        return 0;
     }
-    else
+
+    const jpro_byte** values[2] = { r, s };
+    jpro_int32* lengths[2] = { r_length, s_length };
+    for( jpro_int32 i = 0; i < 2; i++ )
     {
-        error_handler( "Profile type not supported", UNSUPPORTED_PROFILE_TYPE );
+        if( pos + 2 > der_length || der[pos] != 0x02 )
+        {
+            return 0;
+        }
+        jpro_int32 length = der[pos + 1];
+        pos += 2;
+        if( length == 0 || length > 127 || pos + length > der_length || ( der[pos] & 0x80 ) )    //r and s are positive
+        {
+            return 0;
+        }
+        const jpro_byte* value = der + pos;
+        pos += length;
+        while( length > 1 && *value == 0 )
+        {
+            value++;
+            length--;
+        }
+        *values[i] = value;
+        *lengths[i] = length;
+    }
+    return pos == der_length;
+}
+
+/**
+ * @brief Get the length of the raw signature r||s of the signature algorithm of a profile
+ * @param encoded_profile the encoded profile, it can also be a complete seal
+ * @param length the length of the encoded profile
+ * @param component_length the length of the longer one of r and s
+ * @return the length of the raw signature | 0: error occurs
+*/
+jpro_int32 get_raw_signature_length( const jpro_byte* encoded_profile, jpro_int32 length, jpro_int32 component_length )
+{
+    jpro_header_view header;
+    if( jpro_peek_header( encoded_profile, length, &header ) == 0 )
+    {
+        return 0;
+    }
+    const jpro_crypto_info* crypto = get_profile_schema( header.type )->crypto;
+    for( jpro_int32 i = 0; i < crypto->signature_algo_cnt; i++ )
+    {
+        const jpro_int32 signature_length = ( crypto->signature_algos[i].size + 7 ) / 8;     //the size is given in bits
+        if( signature_length / 2 >= component_length )
+        {
+            return signature_length;
+        }
+    }
+    error_handler( "Invalid signature length", INVALID_SIGNATURE_LENGTH );
+    return 0;
+}
+
+/**
+ * @brief Convert a DER-encoded ECDSA signature, e.g. from the openssl command line tool, to the raw form r||s of seals
+ * @param der the DER-encoded signature
+ * @param der_length the length of the DER-encoded signature
+ * @param[out] raw the raw signature, r and s left-padded with zeros, it must not overlap der
+ * @param raw_length the length of the raw signature, e.g. 56 for brainpoolP224r1
+ * @return the length of the raw signature | 0: error occurs
+*/
+jpro_int32 jpro_signature_der_to_raw(const jpro_byte* der, size_t der_length, jpro_byte* raw, jpro_int32 raw_length)
+{
+    const jpro_byte* r;
+    const jpro_byte* s;
+    jpro_int32 r_length, s_length;
+    if( read_der_signature( der, der_length, &r, &r_length, &s, &s_length ) == 0 )
+    {
+        error_handler( "Invalid DER signature", INVALID_SIGNATURE );
+        return 0;
+    }
+    const jpro_int32 half = raw_length / 2;
+    if( raw_length <= 0 || raw_length % 2 != 0 || r_length > half || s_length > half )
+    {
+        error_handler( "Invalid signature length", INVALID_SIGNATURE_LENGTH );
         return 0;
     }
+    memset( raw, 0, raw_length );
+    memcpy( raw + half - r_length, r, r_length );
+    memcpy( raw + raw_length - s_length, s, s_length );
+    return raw_length;
+}
+
+/**
+ * @brief Convert a raw signature r||s of a seal to a DER-encoded ECDSA signature, e.g. for the openssl command line tool
+ * @param raw the raw signature
+ * @param raw_length the length of the raw signature, r and s take half of it each
+ * @param[out] der the DER-encoded signature, JPRO_DER_SIGNATURE_SIZE( raw_length ) bytes are always sufficient
+ * @param capacity the size of the output buffer
+ * @return the length of the DER-encoded signature | 0: error occurs
+*/
+jpro_int32 jpro_signature_raw_to_der(const jpro_byte* raw, jpro_int32 raw_length, jpro_byte* der, size_t capacity)
+{
+    const jpro_int32 half = raw_length / 2;
+    if( raw_length <= 0 || raw_length % 2 != 0 || half > 126 )
+    {
+        error_handler( "Invalid signature length", INVALID_SIGNATURE_LENGTH );
+        return 0;
+    }
+    const jpro_byte* values[2] = { raw, raw + half };
+    jpro_int32 lengths[2] = { half, half };
+    jpro_int32 content_length = 0;
+    for( jpro_int32 i = 0; i < 2; i++ )
+    {
+        while( lengths[i] > 1 && *values[i] == 0 )                          //minimal encoding of the integer
+        {
+            values[i]++;
+            lengths[i]--;
+        }
+        content_length += 2 + lengths[i] + ( *values[i] >> 7 );             //a leading zero keeps the integer positive
+    }
+    const jpro_int32 der_length = 1 + get_length_tag_size( content_length ) + content_length;
+    if( (size_t) der_length > capacity )
+    {
+        error_handler( "Output buffer too small", BUFFER_TOO_SMALL );
+        return 0;
+    }
+
+    jpro_int32 pos = 0;
+    der[pos++] = 0x30;
+    pos += put_length_tag( content_length, der + pos );
+    for( jpro_int32 i = 0; i < 2; i++ )
+    {
+        const jpro_int32 pad = *values[i] >> 7;
+        der[pos++] = 0x02;
+        der[pos++] = lengths[i] + pad;
+        if( pad )
+        {
+            der[pos++] = 0;
+        }
+        memcpy( der + pos, values[i], lengths[i] );
+        pos += lengths[i];
+    }
+    return der_length;
 }
 
 /**
  * @brief Append a signature to an encoded profile to create a seal
  * @param[in] encoded_profile the encoded profile signed by the signature
- * @param[in] signature the signature to be appended to the encoded profile
+ * @param[in] signature the signature to be appended to the encoded profile, raw r||s or DER-encoded (converted to r||s of the profile's signature algorithm)
  * @return the created seal | NULL: error occurs
 */
 jpro_data* append_signature(jpro_data* encoded_profile, jpro_data* signature)
 {
-    jpro_data* length_tag = get_length_tag( signature->length );
+    const jpro_byte* signature_data = signature->data;
+    jpro_int32 signature_length = signature->length;
+    jpro_byte raw_signature[JPRO_MAX_RAW_SIGNATURE_SIZE];
+    const jpro_byte* r;
+    const jpro_byte* s;
+    jpro_int32 r_length, s_length;
+    if( read_der_signature( signature->data, signature->length, &r, &r_length, &s, &s_length ) )
+    {
+        signature_length = get_raw_signature_length( encoded_profile->data, encoded_profile->length, r_length > s_length ? r_length : s_length );
+        if( signature_length == 0 || signature_length > JPRO_MAX_RAW_SIGNATURE_SIZE ||
+            jpro_signature_der_to_raw( signature->data, signature->length, raw_signature, signature_length ) == 0 )
+        {
+            return 0;
+        }
+        signature_data = raw_signature;
+    }
+    const jpro_int32 length_tag_size = get_length_tag_size( signature_length );
 
-    jpro_data* signed_data = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * ( signature->length + encoded_profile->length + length_tag->length + 1 ) );
+    jpro_data* signed_data = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * ( signature_length + encoded_profile->length + length_tag_size + 1 ) );
     if( signed_data == 0 )
     {
         error_handler( "Out of memory", OUT_OF_MEMORY );
         return 0;
     }
-    signed_data->length = signature->length + encoded_profile->length + length_tag->length + 1;
+    signed_data->length = signature_length + encoded_profile->length + length_tag_size + 1;
 
 	memcpy(signed_data->data, encoded_profile->data, encoded_profile->length);
     signed_data->data[encoded_profile->length] = 0xff; //signature tag
-    memcpy( signed_data->data + encoded_profile->length + 1, length_tag->data, length_tag->length );
-	memcpy( signed_data->data + encoded_profile->length + length_tag->length + 1, signature->data, signature->length );
+    put_length_tag( signature_length, signed_data->data + encoded_profile->length + 1 );
+	memcpy( signed_data->data + encoded_profile->length + length_tag_size + 1, signature_data, signature_length );
 
 	return signed_data;
 }
@@ -223,55 +796,105 @@ jpro_data* append_signature(jpro_data* encoded_profile, jpro_data* signature)
 */
 jpro_char* get_last_error(jpro_error_code* error_code)
 {
-	if(error_code) *error_code = global_error_code;
-	return jpro_error_msg;
+	return format_error_state( &jpro_error, error_code );
+}
+
+/**
+ * @brief Format the message of an error state
+ * @param state the error state
+ * @param[out] error_code the error code
+ * @return the error message
+*/
+jpro_char* format_error_state( jpro_error_state* state, jpro_error_code* error_code )
+{
+	if(error_code) *error_code = state->code;
+	snprintf( state->formatted, sizeof( state->formatted ), "%s%s", state->message, state->detail );
+	return state->formatted;
+}
+
+/**
+ * @brief Copy the error state of the calling thread, e.g. into the context of the failed call
+ * @param[out] state the copy of the error state
+*/
+void save_error_state( jpro_error_state* state )
+{
+    state->code = jpro_error.code;
+    state->message = jpro_error.message;
+    memcpy( state->detail, jpro_error.detail, sizeof( state->detail ) );
 }
 
 /**
- * @brief Concatenate strings
- * @param str1 the first string
- * @param str2 the second string
- * @param str3 the third string
- * @return the concatenated string of all input strings
+ * @brief Get the last error code of the calling thread without formatting the message
+ * @return the error code
 */
-jpro_char* cat_strings( jpro_char* buffer, jpro_char* str1, jpro_char* str2, jpro_char* str3 )
+jpro_error_code get_last_error_code(void)
 {
-	strcpy(buffer, str1);
-	strcat(buffer, str2);
-	strcat(buffer, str3);
-	return buffer;
+	return jpro_error.code;
 }
 
 /**
- * @brief Set global_error_code and jpro_error_msg
- * @param error_message the error message
+ * @brief Set the error of the calling thread
+ * @param error_message the error message, a string literal
  * @param error_code the error code
 */
-void error_handler ( jpro_char* error_message, jpro_error_code error_code )
+void error_handler ( const jpro_char* error_message, jpro_error_code error_code )
 {
-    global_error_code = error_code;
-    sprintf( jpro_error_msg, "%s", error_message );
+    jpro_error.code = error_code;
+    jpro_error.message = error_message;
+    jpro_error.detail[0] = '\0';
 }
 
 /**
- *@brief Create a feature_info
- *@param name the name of the feature
- *@param min_length the min length of the feature
- *@param max_length the max length of the feature
- *@param required if the feature is required
- *@param value_type type of the input value
- *@return the created feature_info
+ * @brief Set the error of the calling thread with a detail appended to the message
+ * @param error_message the error message, a string literal
+ * @param detail the detail, e.g. the name of the invalid feature, it is truncated to JPRO_MAX_ERROR_DETAIL_LENGTH - 1 characters
+ * @param error_code the error code
 */
-jpro_feature_info create_feature_info ( jpro_char *name, jpro_int32 min_length, jpro_int32 max_length, jpro_boolean required, jpro_feature_type value_type )
+void error_handler_detail ( const jpro_char* error_message, const jpro_char* detail, jpro_error_code error_code )
 {
-    jpro_feature_info new_feature_info;
-    new_feature_info.name = name;
-    new_feature_info.min_length = min_length;
-    new_feature_info.max_length = max_length;
-    new_feature_info.required = required;
-    new_feature_info.value_type = value_type;
-
-    return new_feature_info;
+    jpro_error.code = error_code;
+    jpro_error.message = error_message;
+    jpro_int32 length = 0;
+    while( length < JPRO_MAX_ERROR_DETAIL_LENGTH - 1 && detail[length] != '\0' )
+    {
+        jpro_error.detail[length] = detail[length];
+        length++;
+    }
+    jpro_error.detail[length] = '\0';
+}
+
+/**
+ * @brief Allocate memory from an arena
+ * @param arena the arena | NULL: allocate on the heap
+ * @param size the number of bytes to allocate
+ * @return the allocated memory | NULL: the arena is exhausted or out of memory
+*/
+void* arena_alloc( jpro_arena* arena, size_t size )
+{
+    if( arena == 0 )
+    {
+        return malloc( size );
+    }
+    const size_t offset = ( arena->used + JPRO_ARENA_ALIGNMENT - 1 ) & ~( (size_t) JPRO_ARENA_ALIGNMENT - 1 );
+    if( offset > arena->capacity || size > arena->capacity - offset )
+    {
+        return 0;
+    }
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+/**
+ * @brief Free memory allocated by arena_alloc, memory in an arena is only released with the whole arena
+ * @param arena the arena the memory was allocated in | NULL: the memory was allocated on the heap
+ * @param ptr the memory to be freed
+*/
+void arena_free( jpro_arena* arena, void* ptr )
+{
+    if( arena == 0 )
+    {
+        free( ptr );
+    }
 }
 
 /**
@@ -281,9 +904,10 @@ jpro_feature_info create_feature_info ( jpro_char *name, jpro_int32 min_length,
  *@param feature_cnt the amount of features of the profile
  *@param features the features of the profile
  *@param crypto the crypto information
+ *@param arena the arena the profile_info is allocated in | NULL: allocate on the heap
  *@return the created profile_info | NULL: error occurs
 */
-jpro_profile_info *create_profile_info ( jpro_profile_type type, jpro_int32 feature_cnt, jpro_feature_info *features, jpro_crypto_info *crypto )
+jpro_profile_info *create_profile_info ( jpro_profile_type type, jpro_int32 feature_cnt, jpro_feature_info *features, jpro_crypto_info *crypto, jpro_arena* arena )
 {
     jpro_header_info empty_header_info;
     empty_header_info.certificate_ref = "";
@@ -299,7 +923,7 @@ jpro_profile_info *create_profile_info ( jpro_profile_type type, jpro_int32 feat
     empty_header_info.signature_date.month = "";
     empty_header_info.signature_date.year = "";
 
-    jpro_profile_info *new_profile_info = malloc( sizeof( jpro_profile_info ) );
+    jpro_profile_info *new_profile_info = arena_alloc( arena, sizeof( jpro_profile_info ) );
     if( new_profile_info == NULL )
     {
         error_handler( "Out of memory", OUT_OF_MEMORY );
@@ -328,176 +952,62 @@ jpro_header_info create_header_info ( jpro_char* issuing_country, jpro_char* sig
     jpro_header_info new_header_info;
     new_header_info.issuing_country = issuing_country;
     new_header_info.signer_country = signer_country;
-    new_header_info.signer_id = signer_id;
-    new_header_info.certificate_ref = certificate_ref;
-    new_header_info.issue_date = issue_date;
-    new_header_info.signature_date = signature_date;
-
-    return new_header_info;
-}
-
-/**
- *@brief Create a crypto_info
- *@param hash_algo_cnt the amount of hash algos
- *@param hash_algos the hash algos
- *@param signature_algo_cnt the amount of signature algos
- *@param signature_algos the signature algos
- *@return the created crypto_info | NULL: error occurs
-*/
-jpro_crypto_info *create_crypto_info ( jpro_int32 hash_algo_cnt, jpro_crypto_algo* hash_algos, jpro_int32 signature_algo_cnt, jpro_crypto_algo*	signature_algos )
-{
-    jpro_crypto_info *new_crypto_info = malloc( sizeof( jpro_crypto_info ) );
-    if( new_crypto_info == NULL )
-    {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return NULL;
-    }
-    new_crypto_info->hash_algo_cnt = hash_algo_cnt;
-    new_crypto_info->hash_algos = hash_algos;
-    new_crypto_info->signature_algo_cnt = signature_algo_cnt;
-    new_crypto_info->signature_algos = signature_algos;
-
-    return new_crypto_info;
-}
-
-/**
- *@brief Create a crypto_algo
- *@param algo the used algorithmus
- *@param size the size of the algo
- *@param valid_from the year from which the algo is valid
- *@param valid_till the year to which the also is valid
- *@return the created crypto_algo
-*/
-jpro_crypto_algo create_crypto_algo ( jpro_char* algo, jpro_int32 size, jpro_int32 valid_from, jpro_int32 valid_till )
-{
-    jpro_crypto_algo new_crypto_algo;
-    new_crypto_algo.algo = algo;
-    new_crypto_algo.size = size;
-    new_crypto_algo.valid_from = valid_from;
-    new_crypto_algo.valid_till = valid_till;
-    return new_crypto_algo;
-}
-
-/**
- *@brief Initializes feature data as empty
- *@param feature the feature data to be initialized
-*/
-void initialize_empty_feature_data( jpro_feature_info *feature )
-{
-    feature->value_date.day = "";
-    feature->value_date.month = "";
-    feature->value_date.year = "";
-    feature->value_int = 0;
-    feature->value_string = "";
-}
-
-/**
- *@brief create a crypto_info for a profile
- *@param profile_type the profile type
- *@return the created crypto_info | NULL: error occurs
-*/
-jpro_crypto_info *get_crypto_info ( jpro_profile_type profile_type )
-{
-    if( profile_type == JPRO_SOCIAL_INSURANCE_CARD )
-    {
-        return get_crypto_sic();
-    }
-    else if ( profile_type == JPRO_VISA )
-    {
-        return get_crypto_visa();
-    }
-    else if ( profile_type == JPRO_ARRIVAL_ATTESTATION_DOCUMENT )
-    {
-        return get_crypto_aad();
-    }
-    else if ( profile_type == JPRO_RESIDENCE_PERMIT )
-    {
-        return get_crypto_rp();
-    }
-    else if ( profile_type == JPRO_SUPPLEMENTARY_SHEET )
-    {
-        return get_crypto_rp_supp_sheet();
-    }
-    else if ( profile_type == JPRO_ADDRESS_STICKER_FOR_ID_CARD )
-    {
-        return get_crypto_addr_st_id();
-    }
-    else if ( profile_type == JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT )
-    {
-        return get_crypto_por();
-    }
-    else
-    {
-        error_handler( "Profile type not supported", UNSUPPORTED_PROFILE_TYPE );
-        return 0;
-    }
+    new_header_info.signer_id = signer_id;
+    new_header_info.certificate_ref = certificate_ref;
+    new_header_info.issue_date = issue_date;
+    new_header_info.signature_date = signature_date;
+
+    return new_header_info;
 }
 
 /**
- *@brief check if a date is valid
- *@param date the date to be checked
- *@return 1: valid | NULL: error occurs
+ *@brief the number of days of every month, indexed by leap year and month
+*/
+static const jpro_byte days_in_month[2][13] = {
+    { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },
+    { 0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 }
+};
+
+/**
+ *@brief Check if a packed date is valid
+ *@param date the date packed as yyyymmdd, e.g. 20220209
+ *@return 1: valid | 0: invalid
 */
-jpro_boolean check_date ( jpro_date date )
+jpro_boolean jpro_date_is_valid(jpro_uint32 date)
 {
-    if ( strlen( date.year ) != 4 ||
-         strlen( date.month) != 2 ||
-         strlen( date.day ) !=2 )
+    const jpro_uint32 year = date / 10000;
+    const jpro_uint32 month = ( date / 100 ) % 100;
+    const jpro_uint32 day = date % 100;
+    if( year < JPRO_MIN_DATE_YEAR || year > JPRO_MAX_DATE_YEAR || month < 1 || month > 12 )
     {
         return 0;
     }
+    const jpro_boolean leap_year = ( year % 4 == 0 && year % 100 != 0 ) || ( year % 400 == 0 );
+    return day >= 1 && day <= days_in_month[leap_year][month];
+}
 
-    for ( jpro_int32 i = 0; i < 2; i++)
-    {
-        if ( isdigit( date.month[i] ) == 0 )
-        {
-            return 0;                       // non numeric char in month
-        }
-        else if ( isdigit( date.day[i] ) == 0 )
-        {
-            return 0;                       // non numeric char in day
-        }
-    }
-    for ( jpro_int32 i = 0; i < 4; i++ )    // non numeric char in year
-    {
-        if (isdigit( date.year[i] ) == 0 )
-        {
-            return 0;
-        }
-    }
-
-    if ( atoi( date.year ) > 2030 ||
-         atoi( date.year ) < 1850 ||
-         atoi( date.month ) > 12 ||
-         atoi( date.month ) < 1 ||
-         atoi( date.day ) > 31 ||
-         atoi( date.day ) < 1)
-    {
-        return 0;
-    }
-    else if ( ( atoi( date.month ) == 4 ||           //check months with 30 days
-                atoi( date.month ) == 6 ||
-                atoi( date.month ) == 9 ||
-                atoi( date.month ) == 11 ) &&
-                atoi( date.day ) > 30 )
+/**
+ *@brief Pack a date given as strings into an integer
+ *@param date the date with a 4-digit year, a 2-digit month and a 2-digit day
+ *@return the date packed as yyyymmdd | 0: the strings are not digits of the expected length
+*/
+jpro_uint32 jpro_date_pack(jpro_date date)
+{
+    if ( strlen( date.year ) != 4 || check_class( date.year, 4, JPRO_CLASS_NUMERIC ) == 0 ||
+         strlen( date.month ) != 2 || check_class( date.month, 2, JPRO_CLASS_NUMERIC ) == 0 ||
+         strlen( date.day ) != 2 || check_class( date.day, 2, JPRO_CLASS_NUMERIC ) == 0 )
     {
         return 0;
     }
-    else if( atoi( date.month ) == 2 )              //check febuary
+    jpro_uint32 packed = 0;
+    for( jpro_int32 i = 0; i < 4; i++ )
     {
-        if( (atoi(date.year)%4 == 0 && atoi(date.year)%100 != 0) || (atoi(date.year)%400 == 0) )
-		{
-			if( atoi( date.day ) > 29 )				//leap year
-				return 0;
-		}
-		else
-		{
-			if( atoi( date.day ) > 28 )
-				return 0;
-		}
+        packed = packed * 10 + ( date.year[i] - '0' );
     }
-
-    return 1;
+    packed = packed * 10 + ( date.month[0] - '0' );
+    packed = packed * 10 + ( date.month[1] - '0' );
+    packed = packed * 10 + ( date.day[0] - '0' );
+    return packed * 10 + ( date.day[1] - '0' );
 }
 
 /**
@@ -505,65 +1015,73 @@ jpro_boolean check_date ( jpro_date date )
  *@param header the header to be checked
  *@return 1: success | 0: error occurs
 */
-jpro_int32 check_header( jpro_header_info header )
+jpro_int32 check_header( const jpro_header_values* header )
 {
     //check length
-    if ( strlen( header.issuing_country ) > 3 ||
-         strlen( header.issuing_country ) == 0 ) //check header data length
+    const jpro_string_view* issuing_country = &header->issuing_country;
+    if ( is_readable( issuing_country ) == 0 ||
+         issuing_country->length > 3 ||
+         issuing_country->length == 0 ) //check header data length
 	{
 		error_handler("Invalid value length of issuing country", INVALID_VALUE_LENGTH);
 		return 0;
 	}
-	if( check_date( header.issue_date ) == 0 ||       //check header dates
-        check_date( header.signature_date ) == 0 )
+	if( jpro_date_is_valid( header->issue_date ) == 0 ||       //check header dates
+        jpro_date_is_valid( header->signature_date ) == 0 )
     {
         error_handler( "Invalid date in header information", INVALID_DATE );
         return 0;
     }
-    if ( strlen( header.signer_country ) != 2 )
+    const jpro_string_view* signer_country = &header->signer_country;
+    if ( is_readable( signer_country ) == 0 || signer_country->length != 2 )
 	{
         error_handler("Invalid value length of signer country", INVALID_VALUE_LENGTH);
         return 0;
 	}
-	if( strlen( header.signer_id ) != 2 )
+	if( is_readable( &header->signer_id ) == 0 || header->signer_id.length != 2 )
     {
         error_handler("Invalid value length of signer id", INVALID_VALUE_LENGTH);
         return 0;
     }
+    if( is_readable( &header->certificate_ref ) == 0 )
+    {
+        error_handler("Invalid value length of certificate reference", INVALID_VALUE_LENGTH);
+        return 0;
+    }
 
     //check value type
-    if( is_alphanum ( header.certificate_ref ) == 0 )
+    if( check_class( header->certificate_ref.data, header->certificate_ref.length, JPRO_CLASS_ALPHANUMERIC ) == 0 )
     {
         error_handler( "Invalid value type for certificate reference", INVALID_VALUE_TYPE );
         return 0;
     }
-    if( is_alphanum( header.signer_id ) == 0 )
+    if( check_class( header->signer_id.data, header->signer_id.length, JPRO_CLASS_ALPHANUMERIC ) == 0 )
     {
         error_handler( "Invalid value type for signer id", INVALID_VALUE_TYPE );
         return 0;
     }
 
-    if( header.issuing_country[0] == '<' )                                                          //to prevent "<<<" input
+    if( issuing_country->data[0] == '<' )                                                           //to prevent "<<<" input
     {
         error_handler( "Invalid value type for issuing country", INVALID_VALUE_TYPE );
         return 0;
     }
-    else if( header.issuing_country[1] == '<' && isupper( header.issuing_country[2] ) != 0 )        //to prevent inputs of form "X<X"
+    else if( issuing_country->length == 3 && issuing_country->data[1] == '<' && isupper( issuing_country->data[2] ) != 0 )     //to prevent inputs of form "X<X"
     {
         error_handler( "Invalid value type for issuing country", INVALID_VALUE_TYPE );
         return 0;
     }
-    for( jpro_int32 loop = 0; loop < strlen( header.issuing_country ); loop++ )
+    for( jpro_int32 loop = 0; loop < issuing_country->length; loop++ )
     {
-        if( isupper( header.issuing_country[loop] ) == 0 && header.issuing_country[loop] != '<' )
+        if( isupper( issuing_country->data[loop] ) == 0 && issuing_country->data[loop] != '<' )
         {
             error_handler( "Invalid value type for issuing country", INVALID_VALUE_TYPE );
             return 0;
         }
     }
-    for( jpro_int32 loop = 0; loop < strlen( header.signer_country ); loop++ )
+    for( jpro_int32 loop = 0; loop < signer_country->length; loop++ )
     {
-        if( isupper( header.signer_country[loop] ) == 0 )
+        if( isupper( signer_country->data[loop] ) == 0 )
         {
             error_handler( "Invalid value type for signers country", INVALID_VALUE_TYPE );
             return 0;
@@ -573,395 +1091,339 @@ jpro_int32 check_header( jpro_header_info header )
 }
 
 /**
- *@brief Encode header information
- *@param profile_info the profile info the header is created for
- *@return the created header | NULL: error occurs
+ *@brief Get the length of the encoded header of a profile without encoding it
+ *@param schema the schema of the profile
+ *@param header the header values
+ *@return the length of the encoded header | 0: error occurs
  */
-jpro_header* encode_header( jpro_profile_info* profile_info )
+jpro_int32 get_header_size( const jpro_profile_schema* schema, const jpro_header_values* header )
 {
-    if( check_header( profile_info->header ) == 0 )
+    const jpro_int32 size_signer = header->signer_country.length + header->signer_id.length;
+    const jpro_int32 size_cert_ref = header->certificate_ref.length;
+    if( schema->version == 0x02 )
     {
-        return 0;
+        return C40_ENCODED_LENGTH( size_signer + size_cert_ref ) + 12;
     }
-
-	jpro_char* iss_cntry_buff = malloc( sizeof(jpro_char) * 4 );
-    if( iss_cntry_buff == 0 )
+    if( size_cert_ref < 1 || size_cert_ref > JPRO_MAX_CERT_REF_LENGTH )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
+        error_handler("Invalid value length of certificate reference", INVALID_VALUE_LENGTH);
         return 0;
     }
-	strcpy( iss_cntry_buff, profile_info->header.issuing_country );
-	for(jpro_int32 i=strlen( profile_info->header.issuing_country ); i<3; i++) //padding
-	{
-		iss_cntry_buff[i] = '<';
-	}
-	iss_cntry_buff[3] = '\0';
+    return C40_ENCODED_LENGTH( size_signer + 2 + size_cert_ref ) + 12;                              //+2 for the length of the certificate reference
+}
 
-    jpro_header* new_header = malloc( sizeof( jpro_header ) );
-    if( new_header == 0 )
+/**
+ *@brief Get the maximal length of an encoded profile of a schema, i.e. with every feature at its maximal length
+ *@param schema the schema of the profile
+ *@return the maximal length of the encoded profile without signature
+ */
+jpro_int32 get_max_encoded_profile_size( const jpro_profile_schema* schema )
+{
+    jpro_int32 size = schema->version == 0x02 ? C40_ENCODED_LENGTH( 4 + 5 ) + 12 : C40_ENCODED_LENGTH( 4 + 2 + JPRO_MAX_CERT_REF_LENGTH ) + 12;
+    for( jpro_int32 r = 0; r < schema->rule_cnt; r++ )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return 0;
+        const jpro_tlv_rule* rule = &schema->rules[r];
+        jpro_int32 length_value = 3;                                                                //JPRO_CODEC_DATE
+        if( rule->codec == JPRO_CODEC_C40 )
+        {
+            const jpro_int32 max_length = schema->features[rule->feature].max_length;
+            length_value = C40_ENCODED_LENGTH( rule->max_chars != 0 && rule->max_chars < max_length ? rule->max_chars : max_length );
+        }
+        else if( rule->codec == JPRO_CODEC_UTF8 )
+        {
+            length_value = schema->features[rule->feature].max_length;
+        }
+        else if( rule->codec == JPRO_CODEC_INTEGER )
+        {
+            length_value = rule->feature_cnt;
+        }
+        size += 1 + ( schema->der_length ? get_length_tag_size( length_value ) : 1 ) + length_value;
     }
-    new_header->magic_constant = 0xDC;
-    jpro_data* cntry_id = 0;
-	cntry_id = c40_encode( iss_cntry_buff );
-    free( iss_cntry_buff );
-	if(cntry_id == 0)
-	{
-		return 0;
-	}
-    new_header->country_id[0] = cntry_id->data[0];
-    new_header->country_id[1] = cntry_id->data[1];
-    free( cntry_id);
+    return size;
+}
 
-    jpro_byte* buffer_issue_date = date_encode( profile_info->header.issue_date );
-    jpro_byte* buffer_creat_date = date_encode( profile_info->header.signature_date );
-    if ( buffer_issue_date == 0 || buffer_creat_date == 0 )
+/**
+ *@brief Encode header information into a buffer
+ *@param schema the schema of the profile
+ *@param header the header values
+ *@param[out] out the output buffer
+ *@param capacity the size of the output buffer
+ *@return the length of the encoded header | 0: error occurs
+ */
+jpro_int32 encode_header_into( const jpro_profile_schema* schema, const jpro_header_values* header, jpro_byte* out, jpro_int32 capacity )
+{
+    if( check_header( header ) == 0 )
     {
         return 0;
     }
-    for( jpro_int32 position = 0; position < 3; position++ )
+    const jpro_byte version = schema->version;
+
+    jpro_char sign_cert_ref[6 + JPRO_MAX_CERT_REF_LENGTH];                                          //signer_cert_ref concenating
+    const jpro_int32 size_cert_ref = header->certificate_ref.length;
+    jpro_int32 sign_cert_ref_length = 4;
+    memcpy( sign_cert_ref, header->signer_country.data, 2 );
+    memcpy( sign_cert_ref + 2, header->signer_id.data, 2 );
+    if( version == 0x03 )
     {
-        new_header->document_issue_date[position] = buffer_issue_date[position];
-        new_header->signature_creation_date[position] = buffer_creat_date[position];
+        if( size_cert_ref < 1 || size_cert_ref > JPRO_MAX_CERT_REF_LENGTH )                         //the length is encoded with two hex digits
+        {
+            error_handler("Invalid value length of certificate reference", INVALID_VALUE_LENGTH);
+            return 0;
+        }
+        sign_cert_ref[sign_cert_ref_length++] = "0123456789ABCDEF"[size_cert_ref >> 4];
+        sign_cert_ref[sign_cert_ref_length++] = "0123456789ABCDEF"[size_cert_ref & 0x0F];
     }
-    free( buffer_issue_date );
-    free( buffer_creat_date );
-
-    if ( profile_info->type == JPRO_SOCIAL_INSURANCE_CARD )
+    else if( version == 0x02 )
     {
-        new_header->version = 0x02;
-        new_header->feature_ref = 0xFC;
-        new_header->document_type = 0x04;
+        if( size_cert_ref != 5 )
+        {
+            error_handler("Invalid value length of certificate reference", INVALID_VALUE_LENGTH);
+            return 0;
+        }
     }
-    else if( profile_info->type == JPRO_VISA )
+    memcpy( sign_cert_ref + sign_cert_ref_length, header->certificate_ref.data, size_cert_ref );
+    sign_cert_ref_length += size_cert_ref;
+
+    const jpro_int32 signer_cert_ref_length = C40_ENCODED_LENGTH( sign_cert_ref_length );
+    const jpro_int32 header_length = signer_cert_ref_length + 12;
+    if( header_length > capacity )
     {
-        new_header->version = 0x03;
-        new_header->feature_ref = 0x5D;
-        new_header->document_type = 0x01;
+        error_handler( "Output buffer too small", BUFFER_TOO_SMALL );
+        return 0;
     }
-    else if( profile_info->type == JPRO_ARRIVAL_ATTESTATION_DOCUMENT )
+
+    jpro_char iss_cntry_buff[4] = "<<<";                                                            //padding
+    memcpy( iss_cntry_buff, header->issuing_country.data, header->issuing_country.length );
+
+    out[0] = 0xDC;
+    out[1] = version;
+    if( c40_encode_into( iss_cntry_buff, 3, out + 2 ) == 0 ||
+        c40_encode_into( sign_cert_ref, sign_cert_ref_length, out + 4 ) == 0 )
     {
-        new_header->version = 0x02;
-        new_header->feature_ref = 0xFD;
-        new_header->document_type = 0x02;
+        return 0;
     }
-    else if( profile_info->type == JPRO_RESIDENCE_PERMIT )
+    if( jpro_date_encode( header->issue_date, out + signer_cert_ref_length + 4 ) == 0 ||
+        jpro_date_encode( header->signature_date, out + signer_cert_ref_length + 7 ) == 0 )
     {
-        new_header->version = 0x03;
-        new_header->feature_ref = 0xFB;
-        new_header->document_type = 0x06;
+        return 0;
     }
-    else if( profile_info->type == JPRO_SUPPLEMENTARY_SHEET )
+    out[signer_cert_ref_length + 10] = schema->feature_ref;
+    out[signer_cert_ref_length + 11] = schema->document_type;
+
+    return header_length;
+}
+
+/**
+ *@brief Find the feature of a profile that matches a feature of the schema
+ *@param profile_info the profile information
+ *@param schema the schema of the profile
+ *@param index the index of the feature in the schema
+ *@return the feature | NULL: the profile does not contain the feature
+*/
+jpro_feature_info* find_schema_feature( jpro_profile_info* profile_info, const jpro_profile_schema* schema, jpro_int32 index )
+{
+    const jpro_char* name = schema->features[index].name;
+    if( index < profile_info->feature_cnt &&                                                        //profiles created by get_profile_info are in schema order
+        ( profile_info->features[index].name == name || strcmp( profile_info->features[index].name, name ) == 0 ) )
     {
-        new_header->version = 0x03;
-        new_header->feature_ref = 0xFA;
-        new_header->document_type = 0x06;
+        return &profile_info->features[index];
     }
-    else if( profile_info->type == JPRO_ADDRESS_STICKER_FOR_ID_CARD )
+    for( jpro_int32 loop = 0; loop < profile_info->feature_cnt; loop++ )
     {
-        new_header->version = 0x03;
-        new_header->feature_ref = 0xF9;
-        new_header->document_type = 0x08;
+        if( strcmp( profile_info->features[loop].name, name ) == 0 )
+        {
+            return &profile_info->features[loop];
+        }
     }
-    else if( profile_info->type == JPRO_PLACE_OF_RESIDENCE_STICKER_FOR_PASSPORT )
+    return 0;
+}
+
+/**
+ *@brief Encode the message zone of a profile following the TLV rules of its schema in a single pass
+ *@param schema the schema of the profile
+ *@param values the feature values in schema order
+ *@param[out] out the output buffer | NULL: only compute the length of the message zone
+ *@param capacity the size of the output buffer
+ *@return the length of the message zone | 0: error occurs
+*/
+jpro_int32 encode_message_zone( const jpro_profile_schema* schema, const jpro_feature_value* values, jpro_byte* out, jpro_int32 capacity )
+{
+    if( out != 0 && schema->check_values != 0 && schema->check_values( values ) == 0 )
     {
-        new_header->version = 0x03;
-        new_header->feature_ref = 0xF8;
-        new_header->document_type = 0x0A;
+        return 0;
     }
 
-    if( new_header->version == 0x03 )
+    jpro_int32 pos = 0;
+    for( jpro_int32 r = 0; r < schema->rule_cnt; r++ )
     {
-        jpro_int32 size_cert_ref = strlen(profile_info->header.certificate_ref);         //signer_cert_ref concenating
-        if( size_cert_ref < 1 )
+        const jpro_tlv_rule* rule = &schema->rules[r];
+        const jpro_feature_value* value = &values[rule->feature];
+        const jpro_string_view* string = &value->value_string;
+        if( rule->omit_if_prefix_of >= 0 )
         {
-            error_handler("Invalid value length of certificate reference", INVALID_VALUE_LENGTH);
-            return 0;
+            const jpro_string_view* reference = &values[rule->omit_if_prefix_of].value_string;
+            if( string->data == 0 ||
+                ( reference->length >= string->length && ( string->length == 0 || memcmp( string->data, reference->data, string->length ) == 0 ) ) )
+            {
+                continue;
+            }
         }
-        jpro_char* sign_cert_ref = malloc( sizeof( jpro_char ) * ( 6 + size_cert_ref + 1 ));
-        if( sign_cert_ref == 0 )
+
+        jpro_int32 length_string = 0;
+        jpro_int32 length_value = 0;
+        if( rule->codec == JPRO_CODEC_C40 )
         {
-            error_handler( "Out of memory", OUT_OF_MEMORY );
-            return 0;
+            length_string = string->length;
+            if( rule->max_chars != 0 && length_string > rule->max_chars )
+            {
+                length_string = rule->max_chars;
+            }
+            length_value = C40_ENCODED_LENGTH( length_string );
+        }
+        else if( rule->codec == JPRO_CODEC_UTF8 )
+        {
+            length_string = string->length;
+            length_value = length_string;
+        }
+        else if( rule->codec == JPRO_CODEC_INTEGER )
+        {
+            length_value = rule->feature_cnt;
+        }
+        else if( rule->codec == JPRO_CODEC_DATE )
+        {
+            length_value = 3;
         }
-        snprintf( sign_cert_ref, 6 + size_cert_ref + 1, "%s%s%02d%s", profile_info->header.signer_country, profile_info->header.signer_id, size_cert_ref, profile_info->header.certificate_ref );
 
-        jpro_data* buffer_sign_cert_ref = c40_encode( sign_cert_ref );
-        if( buffer_sign_cert_ref == 0 )
+        const jpro_int32 length_tag_size = schema->der_length ? get_length_tag_size( length_value ) : 1;
+        if( out == 0 )
         {
-            return 0;
+            pos += 1 + length_tag_size + length_value;
+            continue;
         }
-        new_header->signer_cert_ref = malloc( sizeof( jpro_byte ) * buffer_sign_cert_ref->length );
-        if( new_header->signer_cert_ref == 0 )
+        if( pos + 1 + length_tag_size + length_value > capacity )
         {
-            error_handler( "Out of memory", OUT_OF_MEMORY );
+            error_handler( "Output buffer too small", BUFFER_TOO_SMALL );
             return 0;
         }
-        memcpy( new_header->signer_cert_ref, buffer_sign_cert_ref->data, buffer_sign_cert_ref->length );
-        new_header->signer_cert_ref_length = buffer_sign_cert_ref->length;
 
-        free( buffer_sign_cert_ref );
-        free( sign_cert_ref );
-    }
-    else if( new_header->version == 0x02 )
-    {
-        if( strlen(profile_info->header.certificate_ref) != 5 )
+        out[pos++] = rule->tag;
+        if( schema->der_length )
         {
-            error_handler("Invalid value length of certificate reference", INVALID_VALUE_LENGTH);
-            return 0;
+            pos += put_length_tag( length_value, out + pos );
+        }
+        else
+        {
+            out[pos++] = length_value;
         }
 
-        jpro_char* sign_cert_ref = malloc( sizeof( jpro_char ) * 10 );
-        if( sign_cert_ref == 0 )
+        if( rule->codec == JPRO_CODEC_C40 )
         {
-            error_handler( "Out of memory", OUT_OF_MEMORY );
-            return 0;
+            if( c40_encode_into( string->data, length_string, out + pos ) == 0 )
+            {
+                return 0;
+            }
         }
-        snprintf( sign_cert_ref, 10, "%s%s%s", profile_info->header.signer_country, profile_info->header.signer_id, profile_info->header.certificate_ref );
-        jpro_data* buffer_sign_cert_ref = c40_encode( sign_cert_ref );
-        if( buffer_sign_cert_ref == 0 )
+        else if( rule->codec == JPRO_CODEC_UTF8 )
         {
-            return 0;
+            memcpy( out + pos, string->data, length_string );
         }
-        new_header->signer_cert_ref = malloc( sizeof( jpro_byte ) * buffer_sign_cert_ref->length );
-        if( new_header->signer_cert_ref == 0 )
+        else if( rule->codec == JPRO_CODEC_INTEGER )
         {
-            error_handler( "Out of memory", OUT_OF_MEMORY );
-            return 0;
+            for( jpro_int32 i = 0; i < rule->feature_cnt; i++ )
+            {
+                out[pos + i] = ( jpro_uint32 ) values[rule->feature + i].value_int & 0xFF;
+            }
         }
-        memcpy( new_header->signer_cert_ref, buffer_sign_cert_ref->data, buffer_sign_cert_ref->length );
-        new_header->signer_cert_ref_length = buffer_sign_cert_ref->length;
-
-        free( buffer_sign_cert_ref );
-        free( sign_cert_ref );
+        else if( rule->codec == JPRO_CODEC_DATE )
+        {
+            if( jpro_date_encode( value->value_date, out + pos ) == 0 )
+            {
+                return 0;
+            }
+        }
+        pos += length_value;
     }
-
-    return new_header;
+    return pos;
 }
 
 /**
- *@brief Get a byte sequence for the data of a header
- *@param header the header the byte sequence is created for
- *@param length the length of the header
- *@return the created bytes | NULL: error occurs
+ *@brief Encode a packed date into 3 bytes
+ *@param date the date packed as yyyymmdd, e.g. 20220209
+ *@param[out] out the output buffer of 3 bytes
+ *@return 1: success | 0: error occurs
 */
-jpro_byte* get_header_bytes( jpro_header* header, jpro_int32 length )
+jpro_boolean jpro_date_encode(jpro_uint32 date, jpro_byte* out)
 {
-    jpro_byte* header_bytes = malloc( sizeof( jpro_byte ) * length );
-    if( header_bytes == NULL )
+    if( jpro_date_is_valid( date ) == 0 )
     {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
+        error_handler( "Date encoding failed", DATE_ENCODING_FAILED );
         return 0;
     }
-
-    header_bytes[0] = header->magic_constant;
-    header_bytes[1] = header->version;
-    header_bytes[2] = header->country_id[0];
-    header_bytes[3] = header->country_id[1];
-    for( jpro_int32 i = 0; i < header->signer_cert_ref_length; i++ )
-    {
-        header_bytes[i+4] = header->signer_cert_ref[i];
-    }
-    for( jpro_int32 i = 0; i < 3; i++ )
-    {
-        header_bytes[i + header->signer_cert_ref_length + 4] = header->document_issue_date[i];
-        header_bytes[i + header->signer_cert_ref_length + 7] = header->signature_creation_date[i];
-    }
-    header_bytes[header->signer_cert_ref_length + 10] = header->feature_ref;
-    header_bytes[header->signer_cert_ref_length + 11] = header->document_type;
-
-    return header_bytes;
+    const jpro_uint32 date_int = ( ( date / 100 ) % 100 ) * 1000000 + ( date % 100 ) * 10000 + date / 10000;     //mmddyyyy
+    out[0] = date_int >> 16;
+    out[1] = date_int >> 8;
+    out[2] = date_int;
+    return 1;
 }
 
 /**
- *@brief Encode a date
- *@param date the date that is encoded
- *@return the encoded date | NULL: error occurs
+ *@brief get the number of bytes of the DER-TLV length tag for the length of a feature
+ *@param feature_length the length of the feature
+ *@return the size of the length tag (1 to 5 bytes)
 */
-jpro_byte* date_encode( jpro_date date )
+jpro_int32 get_length_tag_size( jpro_uint32 feature_length )
 {
-    jpro_byte* encoded_date = malloc( sizeof( jpro_byte ) * 3 );
-    if( encoded_date == NULL )
-    {
-        error_handler( "Out of memory", OUT_OF_MEMORY );
-        return 0;
-    }
-
-    jpro_char concatenated_date[9];
-    jpro_int32 cc = snprintf( concatenated_date, 9, "%s%s%s", date.month, date.day, date.year );
-	if( cc <= 0)
-	{
-        error_handler( "Date encoding failed", DATE_ENCODING_FAILED );
-        return 0;
-	}
-    jpro_int32 date_int = atoi( concatenated_date );
-
-    for( jpro_int32 i = 2; i >= 0; i--)
+    jpro_int32 byte_cnt = 0;	//the number of the bytes used to encode the feature length
+    if( feature_length < 128 )
     {
-		encoded_date[i] = date_int & 0xFF;
-		date_int >>= 8;
+        return 1;
     }
-    if( date_int != 0 )
+    while( feature_length != 0 )
     {
-        error_handler( "Date encoding failed", DATE_ENCODING_FAILED );
-        return 0;
+        feature_length >>= 8;
+        byte_cnt++;
     }
-
-    return encoded_date;
+    return byte_cnt + 1;
 }
 
 /**
- *@brief generate data for the length tag for the length of a feature using DER-TLV (ITU-T X.690)
+ *@brief write the length tag for the length of a feature using DER-TLV (ITU-T X.690) into a buffer
  *@param feature_length the length of the feature
- *@return the generated length tag data | 0: ERROR occurs
+ *@param[out] out the output buffer, at least get_length_tag_size( feature_length ) bytes
+ *@return the number of written bytes
 */
-jpro_data* get_length_tag( jpro_uint32 feature_length )
+jpro_int32 put_length_tag( jpro_uint32 feature_length, jpro_byte* out )
 {
-	jpro_data* length_tag;
-    if( feature_length < 128 )
+    const jpro_int32 length_tag_size = get_length_tag_size( feature_length );
+    if( length_tag_size == 1 )
     {
-        length_tag = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ));
-        if( length_tag == 0 )
-        {
-            error_handler("Out of memory", OUT_OF_MEMORY );
-            return 0;
-        }
-        length_tag->length = 1;
-        length_tag->data[0] = feature_length;
-    }
-    else
-    {
-		jpro_uint32 byte_cnt = 0;	//the number of the bytes used to encode the feature length
-		jpro_uint32 tmp = feature_length;
-		while( tmp != 0 )
-		{
-			tmp >>= 8;
-			byte_cnt++;
-		}
-		if( byte_cnt > 4 )	//the length tag consists of one to five bytes
-        {
-            error_handler("Invalid length tag", INVALID_LENGTH_TAG );
-            return 0;
-        }
-		length_tag = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * (byte_cnt + 1) );
-        if( length_tag == 0 )
-        {
-            error_handler("Out of memory", OUT_OF_MEMORY );
-            return 0;
-        }
-		length_tag->data[0] = 128 + byte_cnt;	//the initial byte: 1xxxxxxx, e.g. for byte_cnt=3: 10000011
-		for(jpro_int32 i=byte_cnt; i>0; i--)
-		{
-			length_tag->data[i] = feature_length & 0xFF;
-			feature_length >>= 8;
-		}
-		length_tag->length = byte_cnt + 1;
+        out[0] = feature_length;
+        return 1;
     }
-	return length_tag;
-}
-
-/**
- *@brief check the length of input feature data
- *@param profile_info the profile containing the feature data
- *@return 1 (true): length ok | NULL: error occurs
-*/
-jpro_boolean check_length ( jpro_profile_info *profile_info )
-{
-    for ( jpro_int32 i = 0; i < profile_info->feature_cnt; i++ )
+    out[0] = 128 + length_tag_size - 1;	//the initial byte: 1xxxxxxx, e.g. for byte_cnt=3: 10000011
+    for( jpro_int32 i = length_tag_size - 1; i > 0; i-- )
     {
-        if ( profile_info->features[i].value_type == JPRO_ALPHANUMERIC ||
-             profile_info->features[i].value_type == JPRO_NUMERIC ||
-             profile_info->features[i].value_type == JPRO_BINARY_UTF8 ||
-             profile_info->features[i].value_type == JPRO_BINARY )
-        {
-            if ( profile_info->features[i].min_length > strlen( profile_info->features[i].value_string ) ||
-                 profile_info->features[i].max_length < strlen( profile_info->features[i].value_string ) )
-                {
-					error_handler( cat_strings( jpro_error_msg, "Invalid value length of ", profile_info->features[i].name, ""), INVALID_VALUE_LENGTH);
-                    return 0;
-                }
-        }
-        else if ( profile_info->features[i].value_type == JPRO_INTEGER )
-        {
-            if ( profile_info->features[i].value_int > ( pow( 2, profile_info->features[i].max_length * 8 ) - 1 ) || (
-                 profile_info->features[i].value_int < pow( 2, ( profile_info->features[i].min_length - 1 ) * 8 )  &&  profile_info->features[i].min_length != 1 ) ||
-                 profile_info->features[i].value_int < 0 )          // for min length of 1 byte
-            {
-                error_handler( cat_strings( jpro_error_msg, "Invalid value length of ", profile_info->features[i].name, ""), INVALID_VALUE_LENGTH);
-                return 0;
-            }
-        }
-        else if ( profile_info->features[i].value_type == JPRO_DATE )
-        {
-			if ( check_date(profile_info->features[i].value_date) == 0 )
-			{
-                error_handler( cat_strings( jpro_error_msg, "Invalid date of ", profile_info->features[i].name, ""), INVALID_DATE );
-				return 0;
-			}
-        }
-        else // not an accepted value type
-        {
-			error_handler( cat_strings( jpro_error_msg, "Invalid value type of ", profile_info->features[i].name, ""), INVALID_VALUE_TYPE);
-            return 0;
-        }
+        out[i] = feature_length & 0xFF;
+        feature_length >>= 8;
     }
-    return 1;
+    return length_tag_size;
 }
 
 /**
- *@brief check the value type of input feature data
- *@param profile_info the profile containing the feature data
- *@return 1 (true): value_type ok | 0: error occurs
+ *@brief generate data for the length tag for the length of a feature using DER-TLV (ITU-T X.690)
+ *@param feature_length the length of the feature
+ *@return the generated length tag data | 0: ERROR occurs
 */
-jpro_boolean check_value_type( jpro_profile_info *profile_info )
+jpro_data* get_length_tag( jpro_uint32 feature_length )
 {
-    for ( jpro_int32 i = 0; i < profile_info->feature_cnt; i++ )
+	jpro_data* length_tag = malloc( sizeof( jpro_data ) + sizeof( jpro_byte ) * get_length_tag_size( feature_length ) );
+    if( length_tag == 0 )
     {
-        if ( profile_info->features[i].value_type == JPRO_ALPHANUMERIC )
-        {
-            if( is_alphanum( profile_info->features[i].value_string ) == 0 )
-            {
-                error_handler( cat_strings( jpro_error_msg, "Invalid value type of ", profile_info->features[i].name, ""), INVALID_VALUE_TYPE);
-                return 0;
-            }
-        }
-        else if( profile_info->features[i].value_type == JPRO_NUMERIC )
-        {
-            if( is_numeric( profile_info->features[i].value_string ) == 0 )
-            {
-                error_handler( cat_strings( jpro_error_msg, "Invalid value type of ", profile_info->features[i].name, ""), INVALID_VALUE_TYPE);
-                return 0;
-            }
-        }
-        else if ( profile_info->features[i].value_type == JPRO_BINARY_UTF8 )
-        {
-            if ( is_utf_8( profile_info->features[i].value_string ) == 0 )
-            {
-                error_handler( cat_strings( jpro_error_msg, "Invalid value type of ", profile_info->features[i].name, ""), INVALID_VALUE_TYPE);
-                return 0;
-            }
-        }
-        else if ( profile_info->features[i].value_type == JPRO_BINARY )
-        {
-            return 1;
-        }
-        else if ( profile_info->features[i].value_type == JPRO_INTEGER )
-        {
-			return 1;
-        }
-        else if ( profile_info->features[i].value_type == JPRO_DATE )
-        {
-            return 1; //already checked in check_length()
-        }
-        else
-        {
-            error_handler( cat_strings( jpro_error_msg, "Invalid value type of ", profile_info->features[i].name, ""), INVALID_VALUE_TYPE);
-            return 0;
-        }
+        error_handler("Out of memory", OUT_OF_MEMORY );
+        return 0;
     }
-    return 1;
+    length_tag->length = put_length_tag( feature_length, length_tag->data );
+	return length_tag;
 }
 
 /**
@@ -971,15 +1433,7 @@ jpro_boolean check_value_type( jpro_profile_info *profile_info )
 */
 jpro_boolean is_alphanum( jpro_char* s )
 {
-    for ( jpro_int32 j = 0; j < strlen( s ); j++ )
-    {
-        if ( ( !isalnum( s[j] ) && s[j] != '<' ) ||
-               s[j] > 90 )                                          //1-9 & A-Z <= 90;
-        {
-            return 0;
-        }
-    }
-    return 1;
+    return check_class( s, strlen( s ), JPRO_CLASS_ALPHANUMERIC );
 }
 
 /**
@@ -989,14 +1443,7 @@ jpro_boolean is_alphanum( jpro_char* s )
 */
 jpro_boolean is_numeric( jpro_char* s )
 {
-    for( jpro_int32 i = 0; i < strlen( s ); i++ )
-    {
-        if( !isdigit( s[i] ) )
-        {
-            return 0;
-        }
-    }
-    return 1;
+    return check_class( s, strlen( s ), JPRO_CLASS_NUMERIC );
 }
 
 /**
@@ -1006,66 +1453,7 @@ jpro_boolean is_numeric( jpro_char* s )
 */
 jpro_boolean is_utf_8( jpro_char* s )
 {
-    const jpro_byte *bytes = (const jpro_byte *) s;
-
-    for( jpro_int32 i = 0; i < strlen( s ); i++ )
-    {
-        jpro_int32 amount_ones = 0;
-        jpro_int32 position = 7;
-        while ( ( (bytes[i] >> position) & 0x01 )== 1 )
-        {
-            amount_ones++;
-            position--;
-        }
-
-        if( amount_ones == 2 )
-        {
-            if ( ( bytes[i+1] & 0xc0 ) != 0x80 ||
-                 ( bytes[i] & 0xfe ) == 0xc0 )                                  // overlong?
-            {
-                /* 110xxxxx 10xxxxxx */
-                return 0;
-            }
-            else
-            {
-                i++;
-            }
-        }
-        else if( amount_ones == 3 )
-        {
-            /* 1110xxxx 10xxxxxx 10xxxxxx */
-            if (  ( bytes[i+1] & 0xc0 ) != 0x80 ||
-                  ( bytes[i+2] & 0xc0 ) != 0x80 ||
-                  ( bytes[i] == 0xe0 && ( bytes[1] & 0xe0 ) == 0x80 ))          // overlong?
-            {
-                return 0;
-            }
-            else
-            {
-                i+=2;
-            }
-        }
-        else if( amount_ones == 4 )
-        {
-            /* 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
-            if ( ( bytes[i+1] & 0xc0 ) != 0x80 ||
-                 ( bytes[i+2] & 0xc0 ) != 0x80 ||
-                 ( bytes[i+3] & 0xc0 ) != 0x80 ||
-                 ( bytes[i] == 0xf0 && ( bytes[1] & 0xf0 ) == 0x80 ))           // overlong?
-            {
-                return 0;
-            }
-            else
-            {
-                i+=3;
-            }
-        }
-        else if( amount_ones > 4 || amount_ones == 1 )
-        {
-            return 0;
-        }
-    }
-    return 1;
+    return check_utf_8( s, strlen( s ) );
 }
 
 /**
@@ -1074,20 +1462,15 @@ jpro_boolean is_utf_8( jpro_char* s )
 */
 void free_profile_info( jpro_profile_info *profile_info )
 {
-	free(profile_info->crypto->hash_algos);
-	free(profile_info->crypto->signature_algos);
-    free(profile_info->crypto);
     free(profile_info->features);
     free(profile_info);
 }
 
 /**
- *@brief free memory of a profile_list
+ *@brief free memory of a profile_list, the list returned by get_supported_profiles is static so nothing is freed
  *@param profile_list the profile list to be freed
 */
 void free_profile_list( jpro_profile_list* profile_list)
 {
-	free(profile_list->profile_names);
-	free(profile_list->profile_types);
-	free(profile_list);
+	(void) profile_list;
 }
@@ -34,6 +34,90 @@
 #define VALID_FROM_STICKER 2021
 #define VALID_TIL 2025
 
+#define JPRO_MAX_CERT_REF_LENGTH 0xFF               //the length of the certificate reference is encoded with two hex digits
+
+#define JPRO_PROFILE_CNT 7                          //the number of supported profiles
+#define JPRO_MAX_FEATURE_CNT 5                      //the maximal number of features of a supported profile
+
+#define JPRO_MIN_DATE_YEAR 1850                     //the range of years accepted in dates
+#define JPRO_MAX_DATE_YEAR 2030
+
+#define JPRO_ARENA_ALIGNMENT 16
+
+#define JPRO_ARRAY_SIZE( array ) ( sizeof( array ) / sizeof( ( array )[0] ) )
+
+/**
+ * @brief Static feature definition with empty feature data
+*/
+#define JPRO_FEATURE( name, min_length, max_length, required, value_type ) \
+	{ name, min_length, max_length, required, value_type, "", { "", "", "" }, 0 }
+
+#define JPRO_MAX_ERROR_DETAIL_LENGTH 128            //the maximal length of the detail of an error message including '\0'
+
+/**
+ * @brief Error state of a thread or a context, the message is only formatted when it is requested
+*/
+typedef struct {
+	jpro_error_code	code;
+	const jpro_char*	message;		//static message text
+	jpro_char		detail[JPRO_MAX_ERROR_DETAIL_LENGTH];	//appended to the message, e.g. the name of the invalid feature
+	jpro_char		formatted[256];	//the message returned by get_last_error
+}jpro_error_state;
+
+/**
+ * @brief Bump allocator to place a decoded profile with all its data in a single memory block
+*/
+typedef struct {
+	jpro_byte*	base;
+	size_t		capacity;
+	size_t		used;		//the number of bytes already allocated
+}jpro_arena;
+
+/**
+ * @brief Static TLV rule encoding a single feature with the default settings
+*/
+#define JPRO_TLV( tag, codec, feature ) \
+	{ tag, codec, feature, 1, 0, -1 }
+
+/**
+ * @brief Value codecs of the message zone
+*/
+typedef enum {
+	JPRO_CODEC_C40,
+	JPRO_CODEC_UTF8,		//the string is copied as it is
+	JPRO_CODEC_INTEGER,		//one byte per feature
+	JPRO_CODEC_DATE
+}jpro_codec;
+
+/**
+ * @brief Encoding rule of a TLV in the message zone
+*/
+typedef struct {
+	jpro_byte		tag;
+	jpro_codec		codec;
+	jpro_int32		feature;			//the index of the feature in the schema
+	jpro_int32		feature_cnt;		//the number of consecutive schema features packed into the value
+	jpro_int32		max_chars;			//the maximal number of encoded characters, decoded values are padded with '<' to the feature length | 0: no limit
+	jpro_int32		omit_if_prefix_of;	//the value is omitted if it is missing or a prefix of this feature | -1: required
+}jpro_tlv_rule;
+
+/**
+ * @brief Read-only definition of a profile, shared by all profile_info of the same type
+*/
+typedef struct {
+	jpro_profile_type			type;
+	jpro_byte					version;		//header version
+	jpro_byte					feature_ref;	//document feature definition reference
+	jpro_byte					document_type;	//document type category
+	jpro_int32					feature_cnt;
+	const jpro_feature_info*	features;
+	const jpro_crypto_info*		crypto;
+	jpro_boolean				der_length;		//1: DER-TLV length tags | 0: single length bytes
+	jpro_int32					rule_cnt;
+	const jpro_tlv_rule*		rules;			//the TLVs of the message zone in encoding order
+	jpro_boolean				(*check_values)( const jpro_feature_value* values );	//profile specific check of the values in schema order before encoding | NULL: none
+}jpro_profile_schema;
+
 /**
  * @brief Encoded profile header
 */
@@ -68,48 +152,42 @@ typedef struct {
 }jpro_profile;
 
 
-extern jpro_feature_info create_feature_info ( jpro_char *name, jpro_int32 min_length, jpro_int32 max_length, jpro_boolean required, jpro_feature_type value_type );
-extern jpro_profile_info *create_profile_info ( jpro_profile_type type, jpro_int32 feature_cnt, jpro_feature_info *features, jpro_crypto_info *crypto );
+extern const jpro_profile_schema jpro_schema_visa;
+extern const jpro_profile_schema jpro_schema_aad;
+extern const jpro_profile_schema jpro_schema_sic;
+extern const jpro_profile_schema jpro_schema_rp;
+extern const jpro_profile_schema jpro_schema_rp_supp_sheet;
+extern const jpro_profile_schema jpro_schema_addr_st_id;
+extern const jpro_profile_schema jpro_schema_por;
+
+extern const jpro_profile_schema* get_profile_schema( jpro_profile_type profile_type );
+extern const jpro_profile_schema* get_profile_schema_by_id( jpro_byte version, jpro_byte feature_ref, jpro_byte document_type );
+extern jpro_profile_info *create_profile_info ( jpro_profile_type type, jpro_int32 feature_cnt, jpro_feature_info *features, jpro_crypto_info *crypto, jpro_arena* arena );
 extern jpro_header_info create_header_info ( jpro_char* issuing_country, jpro_char* signer_country, jpro_char*	signer_id, jpro_char* certificate_ref, jpro_date issue_date, jpro_date signature_date );
-extern jpro_crypto_info *create_crypto_info ( jpro_int32 hash_algo_cnt, jpro_crypto_algo* hash_algos, jpro_int32 signature_algo_cnt, jpro_crypto_algo*	signature_algos );
-extern jpro_crypto_algo create_crypto_algo ( jpro_char* algo, jpro_int32 size, jpro_int32 valid_from, jpro_int32 valid_till );
-extern void initialize_empty_feature_data( jpro_feature_info *feature );
-extern jpro_boolean check_date ( jpro_date date );
-extern jpro_crypto_info *get_crypto_info ( jpro_profile_type profile_type );
-extern jpro_boolean check_length ( jpro_profile_info *profile_info );
-extern jpro_boolean check_value_type( jpro_profile_info *profile_list );
+extern jpro_profile_info* get_profile_info_arena( jpro_profile_type profile_type, jpro_arena* arena );
 extern jpro_boolean is_alphanum( jpro_char* s);
 extern jpro_boolean is_numeric( jpro_char* s );
 extern jpro_boolean is_utf_8( jpro_char* s );
-extern jpro_header* encode_header( jpro_profile_info* profile_info );
-extern jpro_byte* get_header_bytes( jpro_header* header, jpro_int32 length );
-extern jpro_byte* date_encode( jpro_date date );
-extern jpro_profile_info *get_sic_info();                           //social insurance card profile
-extern jpro_data *get_encoded_sic( jpro_profile_info *profile_info );
-extern jpro_crypto_info *get_crypto_sic();
-extern jpro_profile_info *get_visa_info();                          //visa profile
-extern jpro_data *get_encoded_visa( jpro_profile_info *profile_info );
-extern jpro_crypto_info *get_crypto_visa();
-extern jpro_profile_info *get_aad_info();                           //arrival attestation document profile
-extern jpro_data *get_encoded_aad( jpro_profile_info *profile_info );
-extern jpro_crypto_info *get_crypto_aad();
-extern jpro_profile_info *get_rp_info();                            //residence permit profile
-extern jpro_data *get_encoded_rp( jpro_profile_info *profile_info );
-extern jpro_crypto_info *get_crypto_rp();
-extern jpro_profile_info *get_addr_st_id_info();                    //address sticker profile for id card
-extern jpro_data *get_encoded_addr_st_id( jpro_profile_info *profile_info );
-extern jpro_crypto_info *get_crypto_addr_st_id();
-extern jpro_profile_info *get_por_info();                           //place of residence sticker profile for passport
-extern jpro_data *get_encoded_por( jpro_profile_info *profile_info );
-extern jpro_crypto_info *get_crypto_por();
-extern jpro_char* cat_strings( jpro_char* buffer, jpro_char* str1, jpro_char* str2, jpro_char* str3 );
+extern jpro_int32 get_header_size( const jpro_profile_schema* schema, const jpro_header_values* header );
+extern jpro_int32 get_max_encoded_profile_size( const jpro_profile_schema* schema );
+extern jpro_int32 encode_header_into( const jpro_profile_schema* schema, const jpro_header_values* header, jpro_byte* out, jpro_int32 capacity );
+extern jpro_int32 get_encoded_profile_size( const jpro_profile_schema* schema, const jpro_header_values* header, const jpro_feature_value* values );
+extern jpro_feature_info* find_schema_feature( jpro_profile_info* profile_info, const jpro_profile_schema* schema, jpro_int32 index );
+extern jpro_int32 encode_message_zone( const jpro_profile_schema* schema, const jpro_feature_value* values, jpro_byte* out, jpro_int32 capacity );
 extern jpro_data* get_length_tag( jpro_uint32 feature_length );
-extern jpro_int32 check_header( jpro_header_info header );
-extern jpro_profile_info *get_rp_supp_sheet_info();
-extern jpro_data *get_encoded_rp_supp_sheet( jpro_profile_info *profile_info );
-extern jpro_crypto_info *get_crypto_rp_supp_sheet();
+extern jpro_int32 get_length_tag_size( jpro_uint32 feature_length );
+extern jpro_int32 put_length_tag( jpro_uint32 feature_length, jpro_byte* out );
+extern jpro_int32 check_header( const jpro_header_values* header );
+extern jpro_boolean read_der_signature( const jpro_byte* der, size_t der_length, const jpro_byte** r, jpro_int32* r_length, const jpro_byte** s, jpro_int32* s_length );
+extern jpro_int32 get_raw_signature_length( const jpro_byte* encoded_profile, jpro_int32 length, jpro_int32 component_length );
 
-extern void error_handler ( jpro_char* error_message, jpro_error_code error_code );
+extern void* arena_alloc( jpro_arena* arena, size_t size );
+extern void arena_free( jpro_arena* arena, void* ptr );
+extern void error_handler ( const jpro_char* error_message, jpro_error_code error_code );
+extern void error_handler_detail ( const jpro_char* error_message, const jpro_char* detail, jpro_error_code error_code );
+extern jpro_error_code get_last_error_code(void);
+extern jpro_char* format_error_state( jpro_error_state* state, jpro_error_code* error_code );
+extern void save_error_state( jpro_error_state* state );
 
 
 
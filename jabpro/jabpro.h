@@ -16,6 +16,13 @@
 #define VERSION "1.0.0"
 #define BUILD_DATE __DATE__
 
+#define JPRO_SIGNATURE_LENGTH_AUTO	0	//signature length for parse_seal to read it from the signature tag
+#define JPRO_MAX_PROFILE_DIGEST_SIZE	32	//the maximal length of the digest of jpro_profile_digest
+#define JPRO_MAX_RAW_SIGNATURE_SIZE		132	//the maximal length of a raw signature r||s (521-bit curves)
+#define JPRO_DER_SIGNATURE_SIZE(n)		( (n) + 9 )	//the maximal length of the DER encoding of a raw signature of n bytes
+
+#include <stddef.h>
+
 typedef unsigned char 		jpro_byte;
 typedef char 				jpro_char;
 typedef unsigned char 		jpro_boolean;
@@ -75,9 +82,25 @@ typedef enum {
 	INVALID_SIGNATURE_LENGTH,
 	INVALID_FEATURE_COUNT,
 	FEATURE_DATA_DOES_NOT_MATCH_PROFILE,
-	REQUIRED_FEATURE_NOT_FOUND
+	REQUIRED_FEATURE_NOT_FOUND,
+	BUFFER_TOO_SMALL,
+	INVALID_SIGNATURE,
+	CRYPTO_FAILED,
+	UNKNOWN_SIGNER,
+	EXPIRED_ALGORITHM
 }jpro_error_code;
 
+/**
+ * @brief Verification status of a seal
+*/
+typedef enum {
+	JPRO_SEAL_VALID,
+	JPRO_SEAL_BAD_STRUCTURE,		//the header or the signature cannot be read
+	JPRO_SEAL_UNKNOWN_SIGNER,		//the document signer is not in the trust store
+	JPRO_SEAL_BAD_SIGNATURE,
+	JPRO_SEAL_EXPIRED_ALGORITHM		//the signature is valid but its algorithms were not valid at the signature date
+}jpro_verify_status;
+
 /**
  * @brief Data structure
 */
@@ -86,6 +109,14 @@ typedef struct {
 	jpro_byte	data[];	//the binary data
 }jpro_data;
 
+/**
+ * @brief View of data in a buffer owned by the caller
+*/
+typedef struct {
+	const jpro_byte*	data;	//the first byte of the data
+	jpro_int32			length;	//the length of data
+}jpro_data_view;
+
 /**
  * @brief Date structure
 */
@@ -95,6 +126,8 @@ typedef struct {
 	jpro_char*	day;	//2-digit like "09"
 }jpro_date;
 
+#define JPRO_DATE_STRING_SIZE	11	//the strings of a date unpacked by jpro_date_unpack, each terminated with '\0'
+
 /**
  * @brief Header information
 */
@@ -149,9 +182,91 @@ typedef struct {
 	jpro_header_info 	header;
 	jpro_int32			feature_cnt;	//the number of features
 	jpro_feature_info*	features;
-	jpro_crypto_info*	crypto;
+	jpro_crypto_info*	crypto;		//read-only, shared by all profiles of the same type
 }jpro_profile_info;
 
+/**
+ * @brief View of a string in a buffer owned by the caller, not terminated with '\0'
+*/
+typedef struct {
+	const jpro_char*	data;	//the first character | NULL: no value
+	jpro_int32			length;	//the length of the string in bytes
+}jpro_string_view;
+
+/**
+ * @brief Header information to be encoded, the strings point into buffers of the caller
+*/
+typedef struct {
+	jpro_string_view	issuing_country;
+	jpro_string_view	signer_country;
+	jpro_string_view	signer_id;
+	jpro_string_view	certificate_ref;
+	jpro_uint32			issue_date;			//packed as yyyymmdd, e.g. 20220209
+	jpro_uint32			signature_date;		//packed as yyyymmdd
+}jpro_header_values;
+
+/**
+ * @brief Feature value to be encoded, the member used depends on the value type of the feature
+*/
+typedef struct {
+	jpro_string_view	value_string;	//alphanumeric, numeric, binary or binary-utf8 value
+	jpro_uint32			value_date;		//packed as yyyymmdd
+	jpro_int32			value_int;
+}jpro_feature_value;
+
+/**
+ * @brief Header view filled without allocating memory
+*/
+typedef struct {
+	jpro_profile_type	type;
+	jpro_byte			version;			//the header version byte: 0x02 (version 3) or 0x03 (version 4)
+	jpro_char			issuing_country[4];
+	jpro_char			signer_country[3];
+	jpro_char			signer_id[3];
+	jpro_char			certificate_ref[256];	//the length is encoded with two hex digits
+	jpro_uint32			issue_date;			//packed as yyyymmdd, e.g. 20220209
+	jpro_uint32			signature_date;		//packed as yyyymmdd
+	jpro_int32			header_length;		//the length of the encoded header in bytes
+}jpro_header_view;
+
+/**
+ * @brief View of a TLV in the message zone of an encoded profile
+*/
+typedef struct {
+	jpro_byte	tag;
+	jpro_int32	feature;	//the index of the feature in the profile | -1: unknown tag
+	jpro_int32	offset;		//the offset of the encoded value in the encoded profile
+	jpro_int32	length;		//the length of the encoded value
+}jpro_feature_view;
+
+/**
+ * @brief Signing or verification key, opaque
+*/
+typedef struct jpro_key jpro_key;
+
+/**
+ * @brief Document signer keys indexed by signer country, signer id and certificate reference, opaque
+*/
+typedef struct jpro_trust_store jpro_trust_store;
+
+/**
+ * @brief Encoder context keeping a profile of every type and the buffer of the encoded profile across calls, opaque
+*/
+typedef struct jpro_encoder_ctx jpro_encoder_ctx;
+
+/**
+ * @brief Decoder context keeping the memory of the decoded profile and the verification state across calls, opaque
+*/
+typedef struct jpro_decoder_ctx jpro_decoder_ctx;
+
+/**
+ * @brief Options of the batch functions
+*/
+typedef struct {
+	jpro_int32			thread_cnt;	//the number of threads including the calling one | 0: default
+	jpro_error_code*	errors;		//optional, receives the error code of every item that failed
+}jpro_batch_opts;
+
 /**
  * @brief Profile list
 */
@@ -165,12 +280,54 @@ typedef struct {
 extern jpro_profile_list* get_supported_profiles();
 extern jpro_profile_info* get_profile_info(jpro_profile_type profile_type);
 extern jpro_data* encode_profile(jpro_profile_info* profile_info);
+extern size_t encode_profiles_batch(jpro_profile_info** profiles, size_t profile_cnt, jpro_data** encoded_profiles, jpro_batch_opts* opts);
+extern jpro_boolean encode_profile_into(jpro_profile_info* profile_info, jpro_byte* out, size_t capacity, size_t* written);
+extern jpro_boolean encode_profile_values_into(jpro_profile_type type, const jpro_header_values* header, const jpro_feature_value* values, jpro_int32 value_cnt, jpro_byte* out, size_t capacity, size_t* written);
+extern size_t jpro_encoded_size(jpro_profile_info* profile_info, jpro_crypto_algo* signature_algo);
 extern jpro_data* append_signature(jpro_data* encoded_profile, jpro_data* signature);
+extern jpro_int32 jpro_signature_der_to_raw(const jpro_byte* der, size_t der_length, jpro_byte* raw, jpro_int32 raw_length);
+extern jpro_int32 jpro_signature_raw_to_der(const jpro_byte* raw, jpro_int32 raw_length, jpro_byte* der, size_t capacity);
+extern jpro_boolean jpro_date_is_valid(jpro_uint32 date);
+extern jpro_boolean jpro_date_encode(jpro_uint32 date, jpro_byte* out);
+extern jpro_uint32 jpro_date_decode(const jpro_byte* encoded_date);
+extern jpro_uint32 jpro_date_pack(jpro_date date);
+extern jpro_date jpro_date_unpack(jpro_uint32 date, jpro_char* buffer);
 extern jpro_header_info* decode_header(jpro_data* seal, jpro_profile_type* type);
+extern jpro_boolean jpro_peek_header(const jpro_byte* seal, size_t length, jpro_header_view* view);
 extern jpro_int32 parse_seal(jpro_data* seal, jpro_data** encoded_profile, jpro_data** signature, jpro_int32 signature_length);
+extern jpro_boolean parse_seal_view(const jpro_data_view* seal, jpro_int32 signature_length, jpro_data_view* encoded_profile, jpro_data_view* signature);
 extern jpro_profile_info* decode_profile(jpro_data* encoded_profile);
+extern jpro_profile_info* decode_profile_view(const jpro_data_view* encoded_profile);
+extern jpro_profile_info* decode_profile_block(jpro_data* encoded_profile);
+extern size_t decode_profiles_batch(jpro_data** seals, size_t seal_cnt, jpro_profile_info** decoded_profiles, jpro_batch_opts* opts);
+extern jpro_profile_info* decode_profile_fields(jpro_data* seal, const jpro_byte* tags, jpro_int32 tag_cnt);
+extern jpro_int32 get_feature_views(jpro_data* encoded_profile, jpro_profile_type* type, jpro_feature_view* views, jpro_int32 max_views);
+extern jpro_int32 decode_feature_view(jpro_data* encoded_profile, jpro_profile_type type, const jpro_feature_view* view, jpro_char* out, jpro_int32 capacity);
+extern jpro_int32 jpro_profile_digest(jpro_data* encoded_profile, const jpro_crypto_algo* hash_algo, jpro_byte* digest);
+extern jpro_key* jpro_load_key(const jpro_byte* data, size_t length);
+extern jpro_data* jpro_sign_profile(jpro_data* encoded_profile, jpro_key* private_key);
+extern jpro_boolean jpro_verify_seal(jpro_data* seal, jpro_key* public_key);
+extern jpro_boolean jpro_verify_seal_view(const jpro_data_view* seal, jpro_key* public_key);
+extern void jpro_free_key(jpro_key* key);
+extern jpro_trust_store* jpro_create_trust_store(void);
+extern jpro_boolean jpro_trust_store_add(jpro_trust_store* store, const jpro_char* signer_country, const jpro_char* signer_id, const jpro_char* certificate_ref, const jpro_byte* certificate, size_t length);
+extern jpro_key* jpro_trust_store_find(const jpro_trust_store* store, const jpro_char* signer_country, const jpro_char* signer_id, const jpro_char* certificate_ref);
+extern jpro_boolean jpro_verify_seal_trusted(jpro_data* seal, const jpro_trust_store* store);
+extern size_t jpro_verify_batch(jpro_data** seals, size_t seal_cnt, const jpro_trust_store* store, jpro_verify_status* status, jpro_batch_opts* opts);
+extern void jpro_free_trust_store(jpro_trust_store* store);
+extern jpro_encoder_ctx* jpro_create_encoder_ctx(void);
+extern jpro_profile_info* jpro_encoder_ctx_profile(jpro_encoder_ctx* ctx, jpro_profile_type type);
+extern jpro_boolean jpro_encode_with(jpro_encoder_ctx* ctx, jpro_profile_info* profile_info, jpro_data_view* encoded_profile);
+extern jpro_char* jpro_encoder_ctx_error(jpro_encoder_ctx* ctx, jpro_error_code* error_code);
+extern void jpro_free_encoder_ctx(jpro_encoder_ctx* ctx);
+extern jpro_decoder_ctx* jpro_create_decoder_ctx(void);
+extern jpro_profile_info* jpro_decode_with(jpro_decoder_ctx* ctx, const jpro_data_view* encoded_profile);
+extern jpro_boolean jpro_verify_with(jpro_decoder_ctx* ctx, const jpro_data_view* seal, jpro_key* public_key);
+extern jpro_char* jpro_decoder_ctx_error(jpro_decoder_ctx* ctx, jpro_error_code* error_code);
+extern void jpro_free_decoder_ctx(jpro_decoder_ctx* ctx);
 extern jpro_char* get_last_error(jpro_uint32* error_code);
 extern void free_profile_info( jpro_profile_info *profile_info );
+extern void free_profile_block( jpro_profile_info *profile_info );
 extern void free_profile_list( jpro_profile_list* profile_list);
 extern void free_header_info_data( jpro_header_info header );
 extern void free_feature_values( jpro_profile_info *profile_info );
@@ -254,7 +254,7 @@ jpro_boolean generate_input_profile( jpro_char* para[] )
     }
     else
     {
-        profile_info->header.certificate_ref = generate_header_data( 2, "ALPHANUM" );
+        profile_info->header.certificate_ref = generate_header_data( get_random_number( 2, 17 ), "ALPHANUM" );    //also lengths of two hex digits
     }
     profile_info->header.signature_date.day = generate_header_data( 2, "DAY" );
     profile_info->header.signature_date.month = generate_header_data( 2, "MONTH" );
@@ -435,14 +435,10 @@ int main( int argc, char* argv[] )
     }
 
 	//decoding
-	jpro_profile_type decoded_profile_type;
-	jpro_header_info* decoded_header_info = decode_header(signed_profile, &decoded_profile_type);
-	jpro_profile_info* decoded_profile_info = get_profile_info(decoded_profile_type);
-	
     jpro_data* enc_profile_dec = 0;
     jpro_data* signature_dec = 0;
 
-    if( parse_seal( signed_profile, &enc_profile_dec, &signature_dec, decoded_profile_info->crypto->signature_algos[0].size ) == 0 || enc_profile_dec == 0 || signature_dec == 0 )
+    if( parse_seal( signed_profile, &enc_profile_dec, &signature_dec, JPRO_SIGNATURE_LENGTH_AUTO ) == 0 || enc_profile_dec == 0 || signature_dec == 0 )
     {
         printf("Error: Parsing seal failed\n");
         free( signed_profile );
@@ -0,0 +1,278 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file sha2.c
+ * @brief SHA-224 and SHA-256 (FIPS 180-4) with SHA-NI and ARMv8 kernels
+ */
+
+#include "jabpro.h"
+#include "sha2.h"
+#include "encoder.h"
+#include <string.h>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define JPRO_SHA2_X86
+#include <immintrin.h>
+#include <cpuid.h>
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+#define JPRO_SHA2_ARMV8
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/**
+ * @brief Round constants
+*/
+static const jpro_uint32 sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/**
+ * @brief Initial hash values
+*/
+static const jpro_uint32 sha224_iv[8] = { 0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4 };
+static const jpro_uint32 sha256_iv[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+#define SHA256_ROTR(x, n) ( ( (x) >> (n) ) | ( (x) << ( 32 - (n) ) ) )
+
+/**
+ * @brief Portable kernel
+*/
+static void sha256_compress_scalar( jpro_uint32 state[8], const jpro_byte* blocks, size_t block_cnt )
+{
+    for( ; block_cnt > 0; block_cnt--, blocks += JPRO_SHA256_BLOCK_SIZE )
+    {
+        jpro_uint32 w[64];
+        for( jpro_int32 i = 0; i < 16; i++ )
+        {
+            w[i] = ( (jpro_uint32)blocks[i * 4] << 24 ) | ( (jpro_uint32)blocks[i * 4 + 1] << 16 ) | ( (jpro_uint32)blocks[i * 4 + 2] << 8 ) | blocks[i * 4 + 3];
+        }
+        for( jpro_int32 i = 16; i < 64; i++ )
+        {
+            const jpro_uint32 s0 = SHA256_ROTR( w[i - 15], 7 ) ^ SHA256_ROTR( w[i - 15], 18 ) ^ ( w[i - 15] >> 3 );
+            const jpro_uint32 s1 = SHA256_ROTR( w[i - 2], 17 ) ^ SHA256_ROTR( w[i - 2], 19 ) ^ ( w[i - 2] >> 10 );
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        jpro_uint32 a = state[0], b = state[1], c = state[2], d = state[3];
+        jpro_uint32 e = state[4], f = state[5], g = state[6], h = state[7];
+        for( jpro_int32 i = 0; i < 64; i++ )
+        {
+            const jpro_uint32 t1 = h + ( SHA256_ROTR( e, 6 ) ^ SHA256_ROTR( e, 11 ) ^ SHA256_ROTR( e, 25 ) ) + ( ( e & f ) ^ ( ~e & g ) ) + sha256_k[i] + w[i];
+            const jpro_uint32 t2 = ( SHA256_ROTR( a, 2 ) ^ SHA256_ROTR( a, 13 ) ^ SHA256_ROTR( a, 22 ) ) + ( ( a & b ) ^ ( a & c ) ^ ( b & c ) );
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+jpro_sha256_kernels sha256_kernels = { "scalar", sha256_compress_scalar };
+
+#ifdef JPRO_SHA2_X86
+
+/**
+ * @brief SHA-NI kernel, the state is kept as ABEF and CDGH as required by sha256rnds2
+*/
+__attribute__((target("sha,sse4.1")))
+static void sha256_compress_shani( jpro_uint32 state[8], const jpro_byte* blocks, size_t block_cnt )
+{
+    const __m128i byte_swap = _mm_set_epi64x( 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL );
+    const __m128i dcba = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i*) &state[0] ), 0xB1 );     //CDAB
+    const __m128i hgfe = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i*) &state[4] ), 0x1B );     //EFGH
+    __m128i abef = _mm_alignr_epi8( dcba, hgfe, 8 );
+    __m128i cdgh = _mm_blend_epi16( hgfe, dcba, 0xF0 );
+
+    for( ; block_cnt > 0; block_cnt--, blocks += JPRO_SHA256_BLOCK_SIZE )
+    {
+        const __m128i abef_save = abef;
+        const __m128i cdgh_save = cdgh;
+        __m128i w[4];                                                       //the message schedule of the last 16 rounds
+        for( jpro_int32 i = 0; i < 16; i++ )                                //4 rounds per step
+        {
+            __m128i msg;
+            if( i < 4 )
+            {
+                msg = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*)( blocks + i * 16 ) ), byte_swap );
+            }
+            else
+            {
+                msg = _mm_sha256msg1_epu32( w[i & 3], w[( i + 1 ) & 3] );
+                msg = _mm_add_epi32( msg, _mm_alignr_epi8( w[( i + 3 ) & 3], w[( i + 2 ) & 3], 4 ) );
+                msg = _mm_sha256msg2_epu32( msg, w[( i + 3 ) & 3] );
+            }
+            w[i & 3] = msg;
+            msg = _mm_add_epi32( msg, _mm_loadu_si128( (const __m128i*) &sha256_k[i * 4] ) );
+            cdgh = _mm_sha256rnds2_epu32( cdgh, abef, msg );
+            abef = _mm_sha256rnds2_epu32( abef, cdgh, _mm_shuffle_epi32( msg, 0x0E ) );
+        }
+        abef = _mm_add_epi32( abef, abef_save );
+        cdgh = _mm_add_epi32( cdgh, cdgh_save );
+    }
+
+    const __m128i feba = _mm_shuffle_epi32( abef, 0x1B );
+    const __m128i dchg = _mm_shuffle_epi32( cdgh, 0xB1 );
+    _mm_storeu_si128( (__m128i*) &state[0], _mm_blend_epi16( feba, dchg, 0xF0 ) );   //DCBA
+    _mm_storeu_si128( (__m128i*) &state[4], _mm_alignr_epi8( dchg, feba, 8 ) );      //HGFE
+}
+
+/**
+ * @brief Select the best kernel supported by the CPU, run once at program start
+*/
+__attribute__((constructor)) static void sha256_select_kernels( void )
+{
+    jpro_uint32 eax, ebx, ecx, edx;
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "sse4.1" ) && __get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) && ( ebx & ( 1u << 29 ) ) )  //CPUID.7.0:EBX.SHA
+    {
+        sha256_kernels.name = "sha-ni";
+        sha256_kernels.compress = sha256_compress_shani;
+    }
+}
+
+#endif
+
+#ifdef JPRO_SHA2_ARMV8
+
+/**
+ * @brief ARMv8 crypto extension kernel
+*/
+__attribute__((target("+crypto")))
+static void sha256_compress_armv8( jpro_uint32 state[8], const jpro_byte* blocks, size_t block_cnt )
+{
+    uint32x4_t abcd = vld1q_u32( &state[0] );
+    uint32x4_t efgh = vld1q_u32( &state[4] );
+
+    for( ; block_cnt > 0; block_cnt--, blocks += JPRO_SHA256_BLOCK_SIZE )
+    {
+        const uint32x4_t abcd_save = abcd;
+        const uint32x4_t efgh_save = efgh;
+        uint32x4_t w[4];                                                    //the message schedule of the last 16 rounds
+        for( jpro_int32 i = 0; i < 16; i++ )                                //4 rounds per step
+        {
+            if( i < 4 )
+            {
+                w[i] = vreinterpretq_u32_u8( vrev32q_u8( vld1q_u8( blocks + i * 16 ) ) );
+            }
+            else
+            {
+                w[i & 3] = vsha256su1q_u32( vsha256su0q_u32( w[i & 3], w[( i + 1 ) & 3] ), w[( i + 2 ) & 3], w[( i + 3 ) & 3] );
+            }
+            const uint32x4_t msg = vaddq_u32( w[i & 3], vld1q_u32( &sha256_k[i * 4] ) );
+            const uint32x4_t abcd_prev = abcd;
+            abcd = vsha256hq_u32( abcd, efgh, msg );
+            efgh = vsha256h2q_u32( efgh, abcd_prev, msg );
+        }
+        abcd = vaddq_u32( abcd, abcd_save );
+        efgh = vaddq_u32( efgh, efgh_save );
+    }
+
+    vst1q_u32( &state[0], abcd );
+    vst1q_u32( &state[4], efgh );
+}
+
+/**
+ * @brief Select the best kernel supported by the CPU, run once at program start
+*/
+__attribute__((constructor)) static void sha256_select_kernels( void )
+{
+    if( getauxval( AT_HWCAP ) & HWCAP_SHA2 )
+    {
+        sha256_kernels.name = "armv8";
+        sha256_kernels.compress = sha256_compress_armv8;
+    }
+}
+
+#endif
+
+/**
+ * @brief Compute a SHA-224 or SHA-256 digest
+ * @param size the digest size in bits, 224 or 256
+ * @param data the data to be hashed
+ * @param length the length of the data
+ * @param[out] digest the digest, at least size / 8 bytes
+ * @return the length of the digest | 0: error occurs
+*/
+jpro_int32 sha2_digest( jpro_int32 size, const jpro_byte* data, size_t length, jpro_byte* digest )
+{
+    jpro_uint32 state[8];
+    if( size == 224 )
+    {
+        memcpy( state, sha224_iv, sizeof( state ) );
+    }
+    else if( size == 256 )
+    {
+        memcpy( state, sha256_iv, sizeof( state ) );
+    }
+    else
+    {
+        error_handler( "Unsupported hash algorithm", CRYPTO_FAILED );
+        return 0;
+    }
+
+    const size_t block_cnt = length / JPRO_SHA256_BLOCK_SIZE;
+    if( block_cnt > 0 )
+    {
+        sha256_kernels.compress( state, data, block_cnt );
+    }
+
+    jpro_byte tail[2 * JPRO_SHA256_BLOCK_SIZE] = { 0 };                     //the rest of the data, 0x80, zero padding and the length in bits
+    const size_t rest = length % JPRO_SHA256_BLOCK_SIZE;
+    memcpy( tail, data + block_cnt * JPRO_SHA256_BLOCK_SIZE, rest );
+    tail[rest] = 0x80;
+    const size_t tail_length = rest < JPRO_SHA256_BLOCK_SIZE - 8 ? JPRO_SHA256_BLOCK_SIZE : 2 * JPRO_SHA256_BLOCK_SIZE;
+    const jpro_uint64 bit_length = (jpro_uint64) length * 8;
+    for( jpro_int32 i = 0; i < 8; i++ )
+    {
+        tail[tail_length - 1 - i] = bit_length >> ( i * 8 );
+    }
+    sha256_kernels.compress( state, tail, tail_length / JPRO_SHA256_BLOCK_SIZE );
+
+    const jpro_int32 digest_length = size / 8;
+    for( jpro_int32 i = 0; i < digest_length / 4; i++ )
+    {
+        digest[i * 4] = state[i] >> 24;
+        digest[i * 4 + 1] = state[i] >> 16;
+        digest[i * 4 + 2] = state[i] >> 8;
+        digest[i * 4 + 3] = state[i];
+    }
+    return digest_length;
+}
+
+/**
+ * @brief Compute the digest of an encoded profile that is signed, e.g. to send it to a remote signer
+ * @param encoded_profile the encoded profile
+ * @param hash_algo the hash algorithm of the profile, SHA-224 or SHA-256
+ * @param[out] digest the digest, at least JPRO_MAX_PROFILE_DIGEST_SIZE bytes
+ * @return the length of the digest | 0: error occurs
+*/
+jpro_int32 jpro_profile_digest(jpro_data* encoded_profile, const jpro_crypto_algo* hash_algo, jpro_byte* digest)
+{
+    return sha2_digest( hash_algo->size, encoded_profile->data, encoded_profile->length, digest );
+}
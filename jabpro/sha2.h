@@ -0,0 +1,30 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file sha2.h
+ * @brief SHA-224 and SHA-256 header
+ */
+
+#ifndef JABPRO_SHA2_H
+#define JABPRO_SHA2_H
+
+#define JPRO_SHA256_BLOCK_SIZE	64
+
+/**
+ * @brief SHA-256 compression kernels, selected at program start by CPU feature detection
+*/
+typedef struct {
+	const jpro_char*	name;																		//"scalar", "sha-ni" or "armv8"
+	void (*compress)( jpro_uint32 state[8], const jpro_byte* blocks, size_t block_cnt );			//processes block_cnt blocks of 64 bytes
+}jpro_sha256_kernels;
+
+extern jpro_sha256_kernels sha256_kernels;
+
+extern jpro_int32 sha2_digest( jpro_int32 size, const jpro_byte* data, size_t length, jpro_byte* digest );
+
+#endif
@@ -0,0 +1,261 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file trust_store.c
+ * @brief Store of document signer keys indexed by signer and certificate reference
+ */
+
+#include "jabpro.h"
+#include "encoder.h"
+#include "crypto.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define JPRO_TRUST_STORE_MIN_CAPACITY   16      //the initial number of slots, always a power of two
+
+/**
+ * @brief Document signer entry of a trust store
+*/
+typedef struct {
+	jpro_uint64	id;					//the hash of signer country, signer id and certificate reference
+	jpro_char	signer[5];			//signer country and signer id
+	jpro_char*	certificate_ref;
+	jpro_key*	key;				//NULL: empty slot
+}jpro_trust_entry;
+
+/**
+ * @brief Trust store, an open-addressing hash table with linear probing
+*/
+struct jpro_trust_store {
+	jpro_int32			capacity;	//the number of slots, a power of two
+	jpro_int32			entry_cnt;
+	jpro_trust_entry*	entries;
+};
+
+/**
+ * @brief Get the 64-bit id of a document signer certificate (FNV-1a)
+ * @param signer_country the signer country
+ * @param signer_id the signer id
+ * @param certificate_ref the certificate reference
+ * @return the id
+*/
+static jpro_uint64 get_signer_id( const jpro_char* signer_country, const jpro_char* signer_id, const jpro_char* certificate_ref )
+{
+    const jpro_char* parts[3] = { signer_country, signer_id, certificate_ref };
+    jpro_uint64 id = 0xcbf29ce484222325ULL;
+    for( jpro_int32 i = 0; i < 3; i++ )
+    {
+        for( const jpro_char* c = parts[i]; ; c++ )
+        {
+            id = ( id ^ (jpro_byte) *c ) * 0x100000001b3ULL;                 //the terminating '\0' separates the parts
+            if( *c == '\0' )
+            {
+                break;
+            }
+        }
+    }
+    return id;
+}
+
+/**
+ * @brief Find the slot of a document signer certificate
+ * @param store the trust store
+ * @param id the id of the certificate
+ * @param signer_country the signer country
+ * @param signer_id the signer id
+ * @param certificate_ref the certificate reference
+ * @return the slot of the certificate or the empty slot it would be stored in
+*/
+static jpro_trust_entry* find_slot( const jpro_trust_store* store, jpro_uint64 id, const jpro_char* signer_country, const jpro_char* signer_id, const jpro_char* certificate_ref )
+{
+    const jpro_int32 mask = store->capacity - 1;
+    for( jpro_int32 i = id & mask; ; i = ( i + 1 ) & mask )
+    {
+        jpro_trust_entry* entry = &store->entries[i];
+        if( entry->key == 0 )
+        {
+            return entry;
+        }
+        if( entry->id == id && memcmp( entry->signer, signer_country, 2 ) == 0 && memcmp( entry->signer + 2, signer_id, 2 ) == 0 &&
+            strcmp( entry->certificate_ref, certificate_ref ) == 0 )
+        {
+            return entry;
+        }
+    }
+}
+
+/**
+ * @brief Double the capacity of a trust store
+ * @param store the trust store
+ * @return 1: success | 0: error occurs
+*/
+static jpro_boolean grow_trust_store( jpro_trust_store* store )
+{
+    jpro_trust_entry* entries = store->entries;
+    const jpro_int32 capacity = store->capacity;
+    store->entries = calloc( 2 * capacity, sizeof( jpro_trust_entry ) );
+    if( store->entries == 0 )
+    {
+        store->entries = entries;
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    store->capacity = 2 * capacity;
+    for( jpro_int32 i = 0; i < capacity; i++ )
+    {
+        if( entries[i].key != 0 )
+        {
+            jpro_int32 slot = entries[i].id & ( store->capacity - 1 );
+            while( store->entries[slot].key != 0 )
+            {
+                slot = ( slot + 1 ) & ( store->capacity - 1 );
+            }
+            store->entries[slot] = entries[i];
+        }
+    }
+    free( entries );
+    return 1;
+}
+
+/**
+ * @brief Create an empty trust store
+ * @return the trust store, to be released with jpro_free_trust_store | NULL: error occurs
+*/
+jpro_trust_store* jpro_create_trust_store(void)
+{
+    jpro_trust_store* store = malloc( sizeof( jpro_trust_store ) );
+    if( store == 0 )
+    {
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    store->capacity = JPRO_TRUST_STORE_MIN_CAPACITY;
+    store->entry_cnt = 0;
+    store->entries = calloc( store->capacity, sizeof( jpro_trust_entry ) );
+    if( store->entries == 0 )
+    {
+        free( store );
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    return store;
+}
+
+/**
+ * @brief Add a document signer certificate to a trust store, the certificate is parsed once here.
+ * An existing entry for the same signer and certificate reference is replaced. Adding is not thread-safe.
+ * @param store the trust store
+ * @param signer_country the signer country as in the seal header, e.g. "DE"
+ * @param signer_id the signer id as in the seal header
+ * @param certificate_ref the certificate reference as in the seal header
+ * @param certificate the certificate or public key, PEM or DER encoded
+ * @param length the length of the certificate
+ * @return 1: success | 0: error occurs
+*/
+jpro_boolean jpro_trust_store_add(jpro_trust_store* store, const jpro_char* signer_country, const jpro_char* signer_id, const jpro_char* certificate_ref, const jpro_byte* certificate, size_t length)
+{
+    if( strlen( signer_country ) != 2 || strlen( signer_id ) != 2 )
+    {
+        error_handler( "Invalid value length of signer country or signer id", INVALID_VALUE_LENGTH );
+        return 0;
+    }
+    if( 4 * ( store->entry_cnt + 1 ) > 3 * store->capacity && grow_trust_store( store ) == 0 )       //keep the load below 3/4
+    {
+        return 0;
+    }
+    jpro_key* key = jpro_load_key( certificate, length );
+    if( key == 0 )
+    {
+        return 0;
+    }
+
+    const jpro_uint64 id = get_signer_id( signer_country, signer_id, certificate_ref );
+    jpro_trust_entry* entry = find_slot( store, id, signer_country, signer_id, certificate_ref );
+    if( entry->key != 0 )
+    {
+        jpro_free_key( entry->key );
+        entry->key = key;
+        return 1;
+    }
+    entry->certificate_ref = malloc( strlen( certificate_ref ) + 1 );
+    if( entry->certificate_ref == 0 )
+    {
+        jpro_free_key( key );
+        error_handler( "Out of memory", OUT_OF_MEMORY );
+        return 0;
+    }
+    strcpy( entry->certificate_ref, certificate_ref );
+    memcpy( entry->signer, signer_country, 2 );
+    memcpy( entry->signer + 2, signer_id, 3 );
+    entry->id = id;
+    entry->key = key;
+    store->entry_cnt++;
+    return 1;
+}
+
+/**
+ * @brief Find the key of a document signer, lookups may run concurrently
+ * @param store the trust store
+ * @param signer_country the signer country
+ * @param signer_id the signer id
+ * @param certificate_ref the certificate reference
+ * @return the key, owned by the trust store | NULL: unknown signer
+*/
+jpro_key* jpro_trust_store_find(const jpro_trust_store* store, const jpro_char* signer_country, const jpro_char* signer_id, const jpro_char* certificate_ref)
+{
+    const jpro_uint64 id = get_signer_id( signer_country, signer_id, certificate_ref );
+    jpro_trust_entry* entry = find_slot( store, id, signer_country, signer_id, certificate_ref );
+    if( entry->key == 0 )
+    {
+        error_handler_detail( "Unknown document signer: ", certificate_ref, UNKNOWN_SIGNER );
+    }
+    return entry->key;
+}
+
+/**
+ * @brief Verify the signature of a seal with the key of its document signer from a trust store
+ * @param seal the seal
+ * @param store the trust store
+ * @return 1: valid signature | 0: unknown signer (UNKNOWN_SIGNER), invalid signature (INVALID_SIGNATURE) or error occurs
+*/
+jpro_boolean jpro_verify_seal_trusted(jpro_data* seal, const jpro_trust_store* store)
+{
+    jpro_header_view header;
+    if( jpro_peek_header( seal->data, seal->length, &header ) == 0 )
+    {
+        return 0;
+    }
+    jpro_key* key = jpro_trust_store_find( store, header.signer_country, header.signer_id, header.certificate_ref );
+    if( key == 0 )
+    {
+        return 0;
+    }
+    return jpro_verify_seal( seal, key );
+}
+
+/**
+ * @brief Free a trust store with all its keys
+ * @param store the trust store
+*/
+void jpro_free_trust_store(jpro_trust_store* store)
+{
+    if( store == 0 )
+    {
+        return;
+    }
+    for( jpro_int32 i = 0; i < store->capacity; i++ )
+    {
+        if( store->entries[i].key != 0 )
+        {
+            jpro_free_key( store->entries[i].key );
+            free( store->entries[i].certificate_ref );
+        }
+    }
+    free( store->entries );
+    free( store );
+}
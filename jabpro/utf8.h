@@ -0,0 +1,26 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file utf8.h
+ * @brief UTF-8 validation header
+ */
+
+#ifndef JABPRO_UTF8_H
+#define JABPRO_UTF8_H
+
+/**
+ * @brief UTF-8 validation kernels, selected at program start by CPU feature detection
+*/
+typedef struct {
+	const jpro_char*	name;														//"scalar", "sse4.1" or "avx2"
+	jpro_boolean (*validate)( const jpro_byte* s, size_t length );				//1: valid UTF-8 (RFC 3629) | 0: invalid
+}jpro_utf8_kernels;
+
+extern jpro_utf8_kernels utf8_kernels;
+
+#endif
@@ -0,0 +1,292 @@
+/**
+ * libjabpro - Encoding/Decoding Library of Digital Seal (BSI TR-03137)
+ *
+ * Copyright 2022 by Fraunhofer SIT. All rights reserved.
+ * See LICENSE file for full terms of use and distribution.
+ *
+ * Contact: Waldemar Berchtold, Huajian Liu <jabcode@sit.fraunhofer.de>
+ *
+ * @file utf8_simd.c
+ * @brief Vectorized UTF-8 validation with runtime dispatch
+ */
+
+#include "jabpro.h"
+#include "utf8.h"
+#include <string.h>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define JPRO_UTF8_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Scalar kernel, 8 ASCII bytes per step and one character per step otherwise
+*/
+static jpro_boolean utf8_validate_scalar( const jpro_byte* s, size_t length )
+{
+    size_t i = 0;
+    while( i < length )
+    {
+        if( i + 8 <= length )
+        {
+            jpro_uint64 word;
+            memcpy( &word, s + i, 8 );
+            if( ( word & 0x8080808080808080ULL ) == 0 )
+            {
+                i += 8;
+                continue;
+            }
+        }
+        const jpro_byte lead = s[i];
+        if( lead < 0x80 )
+        {
+            i++;
+            continue;
+        }
+        size_t continuation_cnt;
+        jpro_byte min_second = 0x80;                                        //the range of the second byte excludes overlong forms,
+        jpro_byte max_second = 0xBF;                                        //surrogates and code points above U+10FFFF
+        if( lead >= 0xC2 && lead <= 0xDF )
+        {
+            continuation_cnt = 1;
+        }
+        else if( lead >= 0xE0 && lead <= 0xEF )
+        {
+            continuation_cnt = 2;
+            min_second = lead == 0xE0 ? 0xA0 : 0x80;
+            max_second = lead == 0xED ? 0x9F : 0xBF;
+        }
+        else if( lead >= 0xF0 && lead <= 0xF4 )
+        {
+            continuation_cnt = 3;
+            min_second = lead == 0xF0 ? 0x90 : 0x80;
+            max_second = lead == 0xF4 ? 0x8F : 0xBF;
+        }
+        else
+        {
+            return 0;
+        }
+        if( i + continuation_cnt >= length || s[i + 1] < min_second || s[i + 1] > max_second )
+        {
+            return 0;
+        }
+        for( size_t k = 2; k <= continuation_cnt; k++ )
+        {
+            if( ( s[i + k] & 0xC0 ) != 0x80 )
+            {
+                return 0;
+            }
+        }
+        i += continuation_cnt + 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief The kernels in use, selected at program start
+*/
+jpro_utf8_kernels utf8_kernels = { "scalar", utf8_validate_scalar };
+
+#ifdef JPRO_UTF8_X86
+
+/**
+ * @brief Error classes of a pair of consecutive bytes (Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte")
+*/
+#define UTF8_TOO_SHORT      ( 1 << 0 )      //a lead byte not followed by a continuation byte
+#define UTF8_TOO_LONG       ( 1 << 1 )      //an ASCII byte followed by a continuation byte
+#define UTF8_OVERLONG_3     ( 1 << 2 )
+#define UTF8_TOO_LARGE      ( 1 << 3 )
+#define UTF8_SURROGATE      ( 1 << 4 )
+#define UTF8_OVERLONG_2     ( 1 << 5 )
+#define UTF8_TOO_LARGE_1000 ( 1 << 6 )
+#define UTF8_OVERLONG_4     ( 1 << 6 )
+#define UTF8_TWO_CONTS      ( 1 << 7 )      //two continuation bytes, valid only as the third or fourth byte of a character
+#define UTF8_CARRY          ( UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS )
+
+/**
+ * @brief Errors by the high nibble of the first byte, the low nibble of the first byte and the high nibble of the second byte
+*/
+static const jpro_byte utf8_byte_1_high[16] = {
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+};
+static const jpro_byte utf8_byte_1_low[16] = {
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    UTF8_CARRY,
+    UTF8_CARRY,
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+};
+static const jpro_byte utf8_byte_2_high[16] = {
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+};
+
+/**
+ * @brief Maximal values of the last three bytes of a block that do not start a character continued in the next block
+*/
+static const jpro_byte utf8_max_last_bytes[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+#define UTF8_TABLE128(t) _mm_loadu_si128( (const __m128i*)(t) )
+#define UTF8_TABLE256(t) _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)(t) ) )
+
+/**
+ * @brief Errors of a block of 16 bytes given the previous block
+*/
+__attribute__((target("sse4.1")))
+static inline __m128i utf8_block_errors_sse41( __m128i input, __m128i prev_input )
+{
+    const __m128i low_nibble = _mm_set1_epi8( 0x0F );
+    const __m128i prev1 = _mm_alignr_epi8( input, prev_input, 15 );
+    const __m128i byte_1_high = _mm_shuffle_epi8( UTF8_TABLE128( utf8_byte_1_high ), _mm_and_si128( _mm_srli_epi16( prev1, 4 ), low_nibble ) );
+    const __m128i byte_1_low = _mm_shuffle_epi8( UTF8_TABLE128( utf8_byte_1_low ), _mm_and_si128( prev1, low_nibble ) );
+    const __m128i byte_2_high = _mm_shuffle_epi8( UTF8_TABLE128( utf8_byte_2_high ), _mm_and_si128( _mm_srli_epi16( input, 4 ), low_nibble ) );
+    const __m128i special_cases = _mm_and_si128( _mm_and_si128( byte_1_high, byte_1_low ), byte_2_high );
+
+    const __m128i prev2 = _mm_alignr_epi8( input, prev_input, 14 );
+    const __m128i prev3 = _mm_alignr_epi8( input, prev_input, 13 );
+    const __m128i is_third_byte = _mm_subs_epu8( prev2, _mm_set1_epi8( (char)( 0xE0 - 0x80 ) ) );     //only 111_____ reaches 0x80
+    const __m128i is_fourth_byte = _mm_subs_epu8( prev3, _mm_set1_epi8( (char)( 0xF0 - 0x80 ) ) );    //only 1111____ reaches 0x80
+    const __m128i must_be_2_3_continuation = _mm_and_si128( _mm_or_si128( is_third_byte, is_fourth_byte ), _mm_set1_epi8( (char) 0x80 ) );
+    return _mm_xor_si128( must_be_2_3_continuation, special_cases );
+}
+
+/**
+ * @brief Validate 16 bytes per iteration, blocks of ASCII only check that no character of the previous block is incomplete
+*/
+__attribute__((target("sse4.1")))
+static jpro_boolean utf8_validate_sse41( const jpro_byte* s, size_t length )
+{
+    const __m128i max_last_bytes = _mm_loadu_si128( (const __m128i*)( utf8_max_last_bytes + 16 ) );
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    for( size_t pos = 0; pos < length; pos += 16 )
+    {
+        __m128i input;
+        if( pos + 16 <= length )
+        {
+            input = _mm_loadu_si128( (const __m128i*)( s + pos ) );
+        }
+        else
+        {
+            jpro_byte tail[16] = { 0 };                                     //padded with ASCII, an incomplete character before it is too short
+            memcpy( tail, s + pos, length - pos );
+            input = _mm_loadu_si128( (const __m128i*) tail );
+        }
+        if( _mm_movemask_epi8( input ) == 0 )                               //ASCII fast path
+        {
+            error = _mm_or_si128( error, prev_incomplete );
+        }
+        else
+        {
+            error = _mm_or_si128( error, utf8_block_errors_sse41( input, prev_input ) );
+            prev_incomplete = _mm_subs_epu8( input, max_last_bytes );
+        }
+        prev_input = input;
+    }
+    error = _mm_or_si128( error, prev_incomplete );
+    return _mm_testz_si128( error, error );
+}
+
+/**
+ * @brief Errors of a block of 32 bytes given the previous block
+*/
+__attribute__((target("avx2")))
+static inline __m256i utf8_block_errors_avx2( __m256i input, __m256i prev_input )
+{
+    const __m256i low_nibble = _mm256_set1_epi8( 0x0F );
+    const __m256i shifted = _mm256_permute2x128_si256( prev_input, input, 0x21 );    //the upper half of the previous and the lower half of this block
+    const __m256i prev1 = _mm256_alignr_epi8( input, shifted, 15 );
+    const __m256i byte_1_high = _mm256_shuffle_epi8( UTF8_TABLE256( utf8_byte_1_high ), _mm256_and_si256( _mm256_srli_epi16( prev1, 4 ), low_nibble ) );
+    const __m256i byte_1_low = _mm256_shuffle_epi8( UTF8_TABLE256( utf8_byte_1_low ), _mm256_and_si256( prev1, low_nibble ) );
+    const __m256i byte_2_high = _mm256_shuffle_epi8( UTF8_TABLE256( utf8_byte_2_high ), _mm256_and_si256( _mm256_srli_epi16( input, 4 ), low_nibble ) );
+    const __m256i special_cases = _mm256_and_si256( _mm256_and_si256( byte_1_high, byte_1_low ), byte_2_high );
+
+    const __m256i prev2 = _mm256_alignr_epi8( input, shifted, 14 );
+    const __m256i prev3 = _mm256_alignr_epi8( input, shifted, 13 );
+    const __m256i is_third_byte = _mm256_subs_epu8( prev2, _mm256_set1_epi8( (char)( 0xE0 - 0x80 ) ) );
+    const __m256i is_fourth_byte = _mm256_subs_epu8( prev3, _mm256_set1_epi8( (char)( 0xF0 - 0x80 ) ) );
+    const __m256i must_be_2_3_continuation = _mm256_and_si256( _mm256_or_si256( is_third_byte, is_fourth_byte ), _mm256_set1_epi8( (char) 0x80 ) );
+    return _mm256_xor_si256( must_be_2_3_continuation, special_cases );
+}
+
+/**
+ * @brief Validate 32 bytes per iteration, blocks of ASCII only check that no character of the previous block is incomplete
+*/
+__attribute__((target("avx2")))
+static jpro_boolean utf8_validate_avx2( const jpro_byte* s, size_t length )
+{
+    const __m256i max_last_bytes = _mm256_loadu_si256( (const __m256i*) utf8_max_last_bytes );
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    for( size_t pos = 0; pos < length; pos += 32 )
+    {
+        __m256i input;
+        if( pos + 32 <= length )
+        {
+            input = _mm256_loadu_si256( (const __m256i*)( s + pos ) );
+        }
+        else
+        {
+            jpro_byte tail[32] = { 0 };                                     //padded with ASCII, an incomplete character before it is too short
+            memcpy( tail, s + pos, length - pos );
+            input = _mm256_loadu_si256( (const __m256i*) tail );
+        }
+        if( _mm256_movemask_epi8( input ) == 0 )                            //ASCII fast path
+        {
+            error = _mm256_or_si256( error, prev_incomplete );
+        }
+        else
+        {
+            error = _mm256_or_si256( error, utf8_block_errors_avx2( input, prev_input ) );
+            prev_incomplete = _mm256_subs_epu8( input, max_last_bytes );
+        }
+        prev_input = input;
+    }
+    error = _mm256_or_si256( error, prev_incomplete );
+    return _mm256_testz_si256( error, error );
+}
+
+/**
+ * @brief Select the best kernel supported by the CPU, run once at program start
+*/
+__attribute__((constructor)) static void utf8_select_kernels( void )
+{
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "avx2" ) )
+    {
+        utf8_kernels.name = "avx2";
+        utf8_kernels.validate = utf8_validate_avx2;
+    }
+    else if( __builtin_cpu_supports( "sse4.1" ) )
+    {
+        utf8_kernels.name = "sse4.1";
+        utf8_kernels.validate = utf8_validate_sse41;
+    }
+}
+
+#endif
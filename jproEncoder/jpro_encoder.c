@@ -8,6 +8,7 @@
 jpro_profile_info* profile_info = 0;
 jpro_int32 number_features = 0;
 jpro_char* file_name = 0;
+jpro_boolean digest_out = 0;
 static jpro_char* year_set[10] = { "2015", "2016", "2017", "2018", "2019", "2020", "2021", "2022", "2023", "2024"};
 static jpro_char* day_set[30] = { "01", "02", "03", "04", "05", "06", "07", "08", "09", "10",
                                   "11", "12", "13", "14", "15", "16", "17", "18", "19", "20",
@@ -32,6 +33,7 @@ void print_usage()
 	printf("<inputs-path>: path to the randomly created input data\n" );
 	printf("jproEncoder --ProfileType <profile-type> --header <input-header> --features <feature1> ... <featureN> --output <output-file> \n");
 	printf("<input-header> of form: <signer-country> <signer-id> <cert-ref> <issuing-country> <issue-date> <sign-date>\n");
+	printf("--digest-out: optional, write only the digest of the encoded profile (SHA-224: 28 bytes, SHA-256: 32 bytes) to <output-file>, e.g. for a remote signer\n");
 	printf("jproEncoder --help: print this help\n ");
 }
 
@@ -477,6 +479,10 @@ jpro_boolean parseParameters( jpro_int32 para_number, jpro_char* para[] )
                 return 0;
             }
         }
+        else if (strcmp( para[position], "--digest-out" ) == 0 )
+        {
+            digest_out = 1;
+        }
         else if (strcmp( para[position], "--output" ) == 0 )
         {
             if( position + 1 > para_number - 1 )
@@ -484,7 +490,7 @@ jpro_boolean parseParameters( jpro_int32 para_number, jpro_char* para[] )
                 printf( "Encoding failed: Not enough values for '%s'\n", para[position] );
                 return 0;
             }
-            file_name = malloc( sizeof(jpro_char) * strlen( para[++position] ));
+            file_name = malloc( sizeof(jpro_char) * ( strlen( para[++position] ) + 1 ) );
             if (file_name == 0)
             {
                 printf( "Encoding failed: Out of memory\n" );
@@ -530,13 +536,32 @@ int main( int argc, char *argv[] )
         return 1;
     }
 
+    jpro_byte digest[JPRO_MAX_PROFILE_DIGEST_SIZE];
+    jpro_int32 digest_length = 0;
+    if( digest_out )
+    {
+        digest_length = jpro_profile_digest( encoded_profile, &profile_info->crypto->hash_algos[0], digest );
+        if( digest_length == 0 )
+        {
+            printf( "Encoding failed: %s\n", get_last_error( 0 ) );
+            return 1;
+        }
+    }
+
     FILE* output_file = fopen( file_name, "wb" );
     if( !output_file )
     {
         printf( "Encoding failed: Opening file failed\n" );
         return 1;
     }
-    fwrite( encoded_profile->data, encoded_profile->length, 1, output_file );
+    if( digest_out )
+    {
+        fwrite( digest, digest_length, 1, output_file );
+    }
+    else
+    {
+        fwrite( encoded_profile->data, encoded_profile->length, 1, output_file );
+    }
     fclose( output_file );
 
     free(profile_info->header.issue_date.year);
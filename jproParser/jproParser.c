@@ -7,14 +7,17 @@
 jpro_data* signed_profile = 0;
 jpro_char* profile_file = 0;
 jpro_char* signature_file = 0;
-jpro_int32 signature_length = 0;
+jpro_int32 signature_length = JPRO_SIGNATURE_LENGTH_AUTO;
+jpro_key* public_key = 0;
 
 void print_usage()
 {
     printf("\n");
     printf("Usage: To split encoded profile and signature\n\n");
-	printf("jproParser --input <input-file> --length <signature_length> --profile <profile-file> --signature <signature-file>\n");
+	printf("jproParser --input <input-file> [--length <signature_length>] --profile <profile-file> --signature <signature-file> [--key <key-file>]\n");
 	printf("->input-file: the path to a SIGNED profile\n");
+	printf("->signature_length: optional, the length of the signature in bytes, read from the signature tag if omitted\n");
+	printf("->key-file: optional, the path to the PUBLIC KEY or CERTIFICATE (PEM or DER) the signature is verified with\n");
 	printf("->profile-file: the path where the ENCODED profile should be saved\n");
 	printf("->signature-file: the path where the SIGNATURE should be saved\n");
 	printf("jproParser --help: print this help\n" );
@@ -68,6 +71,42 @@ jpro_boolean parseParameters( jpro_int32 para_number, jpro_char* para[] )
 
             signature_length = atoi( para[++position] );
         }
+        else if ( strcmp( para[position], "--key") == 0 )
+        {
+            if( position + 1 > para_number - 1 )
+            {
+                printf( "Parsing failed: Not enough values for '%s'\n", para[position] );
+                return 0;
+            }
+
+            FILE* fp = fopen( para[++position], "rb" );
+            if( !fp )
+            {
+                printf( "Parsing failed: Opening file failed\n" );
+                return 0;
+            }
+            fseek( fp, 0, SEEK_END );
+            jpro_int32 size = ftell( fp );
+            fseek( fp, 0, SEEK_SET );
+
+            jpro_byte* key_data = malloc( sizeof(jpro_byte) * size );
+            if( key_data == 0 )
+            {
+                printf("Out of memory\n");
+                fclose( fp );
+                return 0;
+            }
+            size = fread( key_data, sizeof(jpro_byte), size, fp );
+            fclose( fp );
+
+            public_key = jpro_load_key( key_data, size );
+            free( key_data );
+            if( public_key == 0 )
+            {
+                printf( "Parsing failed: %s\n", get_last_error( 0 ) );
+                return 0;
+            }
+        }
         else if ( strcmp( para[position], "--profile") == 0 )
         {
             if( position + 1 > para_number - 1 )
@@ -75,7 +114,7 @@ jpro_boolean parseParameters( jpro_int32 para_number, jpro_char* para[] )
                 printf( "Parsing failed: Not enough values for '%s'\n", para[position] );
                 return 0;
             }
-            profile_file = malloc( sizeof( jpro_char ) * strlen( para[++position] ) );
+            profile_file = malloc( sizeof( jpro_char ) * ( strlen( para[++position] ) + 1 ) );
             if( profile_file == 0 )
             {
                 printf( "Parsing failed: Out of memory\n" );
@@ -97,7 +136,7 @@ jpro_boolean parseParameters( jpro_int32 para_number, jpro_char* para[] )
                 printf( "Parsing failed: Not enough values for '%s'\n", para[position] );
                 return 0;
             }
-            signature_file = malloc( sizeof( jpro_char ) * strlen( para[++position] ) );
+            signature_file = malloc( sizeof( jpro_char ) * ( strlen( para[++position] ) + 1 ) );
             if( signature_file == 0 )
             {
                 printf( "Parsing failed: Out of memory\n" );
@@ -124,7 +163,7 @@ int main( int argc, char *argv[] )
         return 1;
     }
 
-    if( argc < 9 )
+    if( argc < 7 )
     {
         printf( "Parsing failed: invalid amount of arguments\n");
         print_usage();
@@ -135,6 +174,12 @@ int main( int argc, char *argv[] )
         return 1;
     }
 
+    if( public_key != 0 && jpro_verify_seal( signed_profile, public_key ) == 0 )
+    {
+        printf( "Parsing failed: %s\n", get_last_error( 0 ) );
+        return 1;
+    }
+
     jpro_data* encoded_profile = 0;
     jpro_data* signature = 0;
     if ( parse_seal( signed_profile, &encoded_profile, &signature, signature_length ) == 0)
@@ -166,6 +211,7 @@ int main( int argc, char *argv[] )
     free( signature );
     free( encoded_profile );
     free( signed_profile );
+    jpro_free_key( public_key );
     free(signature_file);
     free(profile_file);
 
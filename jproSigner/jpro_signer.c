@@ -7,6 +7,7 @@
 
 jpro_data* encoded_profile = 0;
 jpro_data* signature = 0;
+jpro_key* private_key = 0;
 jpro_char* file_name = 0;
 
 /**
@@ -17,10 +18,12 @@ void print_usage()
     printf("\n");
     printf("Usage: to append signature to an encoded profile\n\n");
 	printf("jproSigner --profile <profile-file> --signature <signature-file> --output <output-file>\n");
+	printf("jproSigner --profile <profile-file> --key <key-file> --output <output-file>\n");
 	printf("->profile-file: the path to a ENCODED profile\n");
-	printf("->signature-file: the path to a SIGNATURE\n");
+	printf("->signature-file: the path to a SIGNATURE, raw r||s or DER-encoded as written by openssl\n");
+	printf("->key-file: the path to the PRIVATE KEY (PEM or DER) to sign the profile with\n");
 	printf("->output-file: the path where the SIGNED profile should be saved\n");
-	printf("jproSigner --help: print this help\n );
+	printf("jproSigner --help: print this help\n" );
 }
 
 /**
@@ -90,6 +93,42 @@ jpro_boolean parseParameters( jpro_int32 para_number, jpro_char* para[] )
 
             fclose( fp );
         }
+        else if ( strcmp( para[position], "--key") == 0 )
+        {
+            if( position + 1 > para_number - 1 )
+            {
+                printf( "Signing failed: Not enough values for '%s'\n", para[position] );
+                return 0;
+            }
+
+            FILE* fp = fopen( para[++position], "rb" );
+            if( !fp )
+            {
+                printf( "Signing failed: Opening file failed\n" );
+                return 0;
+            }
+            fseek( fp, 0, SEEK_END );
+            jpro_int32 size_key = ftell( fp );
+            fseek( fp, 0, SEEK_SET );
+
+            jpro_byte* key_data = malloc( sizeof(jpro_byte) * size_key );
+            if( key_data == 0 )
+            {
+                printf("Signing failed: Out of memory\n");
+                fclose( fp );
+                return 0;
+            }
+            size_key = fread( key_data, sizeof(jpro_byte), size_key, fp );
+            fclose( fp );
+
+            private_key = jpro_load_key( key_data, size_key );
+            free( key_data );
+            if( private_key == 0 )
+            {
+                printf( "Signing failed: %s\n", get_last_error( 0 ) );
+                return 0;
+            }
+        }
         else if ( strcmp( para[position], "--output") == 0 )
         {
             if( position + 1 > para_number - 1 )
@@ -97,7 +136,7 @@ jpro_boolean parseParameters( jpro_int32 para_number, jpro_char* para[] )
                 printf( "Signing failed: Not enough values for '%s'\n", para[position] );
                 return 0;
             }
-            file_name = malloc( sizeof( jpro_char ) * strlen( para[++position] ) );
+            file_name = malloc( sizeof( jpro_char ) * ( strlen( para[++position] ) + 1 ) );
             if( file_name == 0 )
             {
                 printf( "Signing failed: Out of memory\n" );
@@ -134,12 +173,31 @@ int main( int argc, char *argv[] )
     {
         return 1;
     }
-    jpro_data* signed_profile = append_signature( encoded_profile, signature );
-    if( signed_profile == 0 )
+    if( encoded_profile == 0 || file_name == 0 || ( signature == 0 && private_key == 0 ) )
     {
-        printf( "Signing failed: Appending signature failed\n" );
+        printf( "Signing failed: invalid arguments\n");
+        print_usage();
         return 1;
     }
+    jpro_data* signed_profile = 0;
+    if( private_key != 0 )
+    {
+        signed_profile = jpro_sign_profile( encoded_profile, private_key );
+        if( signed_profile == 0 )
+        {
+            printf( "Signing failed: %s\n", get_last_error( 0 ) );
+            return 1;
+        }
+    }
+    else
+    {
+        signed_profile = append_signature( encoded_profile, signature );
+        if( signed_profile == 0 )
+        {
+            printf( "Signing failed: Appending signature failed\n" );
+            return 1;
+        }
+    }
     FILE* fp = fopen( file_name, "wb" );
     if( !fp )
     {
@@ -151,6 +209,8 @@ int main( int argc, char *argv[] )
 
     free( signature );
     free( encoded_profile );
+    free( signed_profile );
+    jpro_free_key( private_key );
     free(file_name);
 
     return 0;